@@ -0,0 +1,251 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <ft232gpio/ft232.h>
+#include <ft232gpio/ft232_sim.h>
+#include <ft232gpio/expander.h>
+#include <ft232gpio/i2c.h>
+#include <ft232gpio/lcd1602.h>
+#include <ft232gpio/lcd1602_parallel.h>
+#include <ft232gpio/span.h>
+#include <ft232gpio/spi.h>
+#include <ft232gpio/ssd1306.h>
+#include <ft232gpio/tm1637.h>
+#include <ft232gpio/trace.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+#include <time.h>
+
+// driver operations against a simulated adapter, or a real one with --real.
+// prints per operation USB transfers, samples on the wire, bus time at the
+// sample rate, host CPU time and wall time. --json prints one object per
+// line to compare runs before and after a change. --trace writes the
+// samples of the run as VCD. --spans writes driver spans as Chrome trace
+// JSON, with a library built with FT232GPIO_SPANS=1.
+
+struct Result
+{
+  const char *name;
+  uint32_t iterations;
+  double transfers; // per operation, as others below
+  double bytes;
+  double bus_usecs;
+  double cpu_usecs;
+  double wall_usecs;
+};
+
+static double cpu_usecs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static Result measure(ft232gpio::FT232 &ft232, const char *name, uint32_t iterations,
+                      std::function<void(uint32_t)> op)
+{
+  ft232.reset_stats();
+  double cpu = cpu_usecs();
+  auto wall = std::chrono::steady_clock::now();
+
+  for (uint32_t i = 0; i < iterations; ++i)
+    op(i);
+
+  Result r;
+  r.name = name;
+  r.iterations = iterations;
+  r.cpu_usecs = (cpu_usecs() - cpu) / iterations;
+  auto elapsed = std::chrono::steady_clock::now() - wall;
+  r.wall_usecs = std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+  r.transfers = double(ft232.stats().transfers) / iterations;
+  r.bytes = double(ft232.stats().bytes) / iterations;
+  r.bus_usecs = r.bytes * 1e6 / ft232.sample_rate();
+  return r;
+}
+
+static void print(const Result &r, bool json)
+{
+  if (json)
+  {
+    printf("{\"op\":\"%s\",\"iterations\":%u,\"transfers\":%.2f,\"bytes\":%.1f,"
+           "\"bus_usecs\":%.1f,\"cpu_usecs\":%.2f,\"wall_usecs\":%.1f}\n",
+           r.name, r.iterations, r.transfers, r.bytes, r.bus_usecs, r.cpu_usecs, r.wall_usecs);
+    return;
+  }
+  printf("%-24s %9.2f %9.1f %11.1f %10.2f %11.1f\n", r.name, r.transfers, r.bytes, r.bus_usecs,
+         r.cpu_usecs, r.wall_usecs);
+}
+
+static void bench(ft232gpio::FT232 &ft232, uint32_t iterations, bool json)
+{
+  if (not json)
+    printf("%-24s %9s %9s %11s %10s %11s\n", "operation", "transfers", "bytes", "bus_usecs",
+           "cpu_usecs", "wall_usecs");
+
+  const char *text = "Hello World! 123";
+  const char *digits = "0123456789";
+
+  ft232gpio::I2C i2c;
+  i2c.init(&ft232, 0x27);
+  print(measure(ft232, "i2c.write_byte", iterations,
+                [&](uint32_t i) { i2c.write_byte(true, true, i & 0xFF); }),
+        json);
+
+  ft232gpio::LCD1602 lcd;
+  lcd.init(&i2c);
+  print(measure(ft232, "lcd1602.puts", iterations,
+                [&](uint32_t i) {
+                  lcd.move(0, 0);
+                  lcd.puts(text);
+                }),
+        json);
+  print(measure(ft232, "lcd1602.clear", iterations, [&](uint32_t i) { lcd.clear(); }), json);
+  lcd.release();
+
+  ft232gpio::LCD1602Parallel lcdp;
+  lcdp.init(&ft232);
+  print(measure(ft232, "lcd1602_parallel.puts", iterations,
+                [&](uint32_t i) {
+                  lcdp.move(0, 0);
+                  lcdp.puts(text);
+                }),
+        json);
+  lcdp.release();
+
+  ft232gpio::Expander expander;
+  expander.init(&i2c, 0x00);
+  print(measure(ft232, "expander.write", iterations,
+                [&](uint32_t i) { expander.write(0xFF, i & 0xFF); }),
+        json);
+  expander.release();
+  i2c.release();
+
+  ft232gpio::I2C i2c_oled;
+  i2c_oled.init(&ft232, SSD1306_ADDR);
+  ft232gpio::SSD1306 oled;
+  oled.init(&i2c_oled);
+  print(measure(ft232, "ssd1306.present_line", iterations,
+                [&](uint32_t i) {
+                  char line[16];
+                  snprintf(line, sizeof(line), "%8u", i);
+                  oled.text(0, 0, line);
+                  oled.present();
+                }),
+        json);
+  oled.release();
+  i2c_oled.release();
+
+  ft232gpio::TM1637 tm1637;
+  tm1637.init(&ft232);
+  print(measure(ft232, "tm1637.digits", iterations,
+                [&](uint32_t i) {
+                  uint8_t data[4] = {uint8_t(digits[i % 10]), uint8_t(digits[(i + 1) % 10]),
+                                     uint8_t(digits[(i + 2) % 10]), uint8_t(digits[(i + 3) % 10])};
+                  tm1637.digits(data, i & 1);
+                }),
+        json);
+  tm1637.release();
+
+  ft232gpio::SPI spi;
+  spi.init(&ft232);
+  print(measure(ft232, "spi.transfer4", iterations,
+                [&](uint32_t i) {
+                  uint8_t out[4] = {uint8_t(i), 0x01, 0x02, 0x03};
+                  uint8_t in[4];
+                  spi.transfer(out, in, sizeof(out));
+                }),
+        json);
+  spi.release();
+}
+
+int main(int argc, char **argv)
+{
+  bool real = false;
+  bool json = false;
+  const char *trace_path = nullptr;
+  const char *spans_path = nullptr;
+  uint32_t iterations = 100;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "--real") == 0)
+      real = true;
+    else if (strcmp(argv[i], "--json") == 0)
+      json = true;
+    else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+      iterations = strtoul(argv[++i], nullptr, 0);
+    else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+      trace_path = argv[++i];
+    else if (strcmp(argv[i], "--spans") == 0 && i + 1 < argc)
+      spans_path = argv[++i];
+    else
+    {
+      fprintf(stderr,
+              "usage: %s [--real] [--json] [--iterations N] [--trace out.vcd] [--spans out.json]\n",
+              argv[0]);
+      return -1;
+    }
+  }
+  if (iterations == 0)
+    iterations = 1;
+
+  if (spans_path)
+  {
+    if (not FT232GPIO_SPANS)
+      fprintf(stderr, "spans are not compiled, build with FT232GPIO_SPANS=1\n");
+    ft232gpio::span_thread_name("bench");
+    ft232gpio::span_enable(true);
+  }
+
+  ft232gpio::FT232Sim sim;
+  ft232gpio::FT232 usb;
+  ft232gpio::FT232 &ft232 = real ? usb : static_cast<ft232gpio::FT232 &>(sim);
+  if (!ft232.init())
+    return -1;
+
+  ft232gpio::Trace trace;
+  if (trace_path)
+    ft232.tap(&trace);
+
+  bench(ft232, iterations, json);
+
+  ft232.tap(nullptr);
+  if (trace_path)
+  {
+    auto stats = trace.stats();
+    fprintf(stderr, "trace %llu transfers, %llu samples, %llu us idle, %llu dropped\n",
+            (unsigned long long)stats.transfers, (unsigned long long)stats.samples,
+            (unsigned long long)stats.idle_nsecs / 1000, (unsigned long long)stats.dropped);
+    trace.write_vcd(trace_path);
+  }
+  if (spans_path)
+  {
+    ft232gpio::span_enable(false);
+    if (ft232gpio::span_dropped())
+      fprintf(stderr, "spans %llu dropped\n", (unsigned long long)ft232gpio::span_dropped());
+    ft232gpio::span_write_json(spans_path);
+  }
+
+  ft232.release();
+
+  return 0;
+}
@@ -15,6 +15,7 @@
  */
 
 #include <ft232gpio/ft232.h>
+#include <ft232gpio/pwm.h>
 
 #include <unistd.h>
 
@@ -58,6 +59,25 @@ int main(int argc, char **argv)
   ft232.write_data(&data, 1);
   sleep(1);
 
+  // dim DTR up and down with 1ms PWM, CTS stays at half
+  ft232gpio::PWM pwm;
+  pwm.start(&ft232, 0x18, 1000);
+  pwm.duty(0x08, 500);
+  for (int i = 0; i < 3; i++)
+  {
+    for (int d = 0; d <= 1000; d += 50)
+    {
+      pwm.duty(0x10, d);
+      msleep(50);
+    }
+    for (int d = 1000; d >= 0; d -= 50)
+    {
+      pwm.duty(0x10, d);
+      msleep(50);
+    }
+  }
+  pwm.stop();
+
   ft232.release();
 
   return 0;
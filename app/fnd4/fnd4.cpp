@@ -16,8 +16,10 @@
 
 #include <ft232gpio/ft232.h>
 #include <ft232gpio/tm1637.h>
+#include <ft232gpio/tm1637_anim.h>
+#include <ft232gpio/seg7.h>
 
-#include <random>
+#include <ctime>
 
 #include <unistd.h>
 
@@ -41,27 +43,38 @@ int main(int argc, char **argv)
 
   int i, j;
   uint8_t data[4];
-  for (i = 0; i < 4; ++i)
-    data[i] = 0xff;
-  tm1637.digits(data, true);
+  uint8_t all[TM1637_DIGITS_MAX];
+  for (i = 0; i < TM1637_DIGITS_MAX; ++i)
+    all[i] = 0xff;
 
-  for (j = 0; j < 3; ++j)
-    for (i = 1; i <= 8; ++i)
-    {
-      tm1637.bright(i);
-      msleep(100);
-    }
+  // brightness ramp 3 times, then scroll, at 10 frames per second
+  ft232gpio::TM1637Animation anim;
+  anim.load(&tm1637, ft232gpio::tm1637_fade(all, 1, 8));
+  anim.start(10);
+  msleep(2400);
+  anim.stop();
 
-  std::random_device rd;
-  std::mt19937 mt(rd());
-  std::uniform_int_distribution<uint8_t> dist(0, 0x7f);
+  anim.load(&tm1637, ft232gpio::tm1637_scroll("HELLO 1637", 4, 4));
+  anim.start(5, false);
+  while (anim.running())
+    msleep(100);
 
-  for (j = 0; j < 25; ++j)
+  // count down with one decimal
+  for (j = 100; j >= -20; --j)
   {
-    for (i = 0; i < 4; ++i)
-      data[i] = dist(mt);
+    ft232gpio::seg7_fixed(data, 4, j, 1);
     tm1637.digits(data, false);
-    msleep(100);
+    msleep(50);
+  }
+
+  // clock with blinking colon
+  for (j = 0; j < 10; ++j)
+  {
+    std::time_t now = std::time(nullptr);
+    std::tm *tl = std::localtime(&now);
+    ft232gpio::seg7_time(data, tl->tm_hour, tl->tm_min, (j & 1) == 0);
+    tm1637.digits(data, false);
+    msleep(500);
   }
 
   tm1637.release();
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ft232gpio/ft232.h>
+#include <ft232gpio/tm1637.h>
+#include <ft232gpio/tm1637_keys.h>
+
+#include <chrono>
+#include <cstdio>
+
+#include <signal.h>
+
+static bool _do_loop = true;
+
+void signal_handler(int sig)
+{
+  printf("Ctrl+Break!\r\n");
+  _do_loop = false;
+}
+
+int main(int argc, char **argv)
+{
+  signal(SIGINT, signal_handler);
+
+  ft232gpio::FT232 ft232;
+  if (!ft232.init())
+    return -1;
+
+  ft232gpio::TM1637 tm1637;
+  tm1637.init(&ft232);
+
+  ft232gpio::TM1637Keys keys;
+  keys.start(&tm1637, 10);
+
+  auto start = std::chrono::steady_clock::now();
+  while (_do_loop)
+  {
+    ft232gpio::KeyEvent event;
+    if (!keys.wait(event, 100))
+      continue;
+
+    auto msec = std::chrono::duration_cast<std::chrono::milliseconds>(event.time - start);
+    printf("%8lld ms key %d %s\r\n", (long long)msec.count(), event.key,
+           event.pressed ? "pressed" : "released");
+  }
+
+  keys.stop();
+  tm1637.release();
+  ft232.release();
+
+  return 0;
+}
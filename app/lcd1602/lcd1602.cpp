@@ -17,8 +17,10 @@
 #include <ft232gpio/ft232.h>
 #include <ft232gpio/i2c.h>
 #include <ft232gpio/lcd1602.h>
+#include <ft232gpio/lcd1602_parallel.h>
 
 #include <cstdio>
+#include <cstring>
 
 #include <signal.h>
 #include <unistd.h>
@@ -31,7 +33,7 @@ void signal_handler(int sig)
   _do_loop = false;
 }
 
-void show_lcd1602(ft232gpio::LCD1602 &lcd1602)
+void show_lcd1602(ft232gpio::HD44780 &lcd1602)
 {
   while (_do_loop)
   {
@@ -43,6 +45,10 @@ void show_lcd1602(ft232gpio::LCD1602 &lcd1602)
     lcd1602.puts("World!");
     sleep(1);
 
+    lcd1602.marquee(1, "Hello World! from FT232 GPIO", 250);
+    lcd1602.marquee_run(40);
+    lcd1602.marquee_stop();
+
     lcd1602.clear();
     sleep(1);
   }
@@ -56,6 +62,21 @@ int main(int argc, char **argv)
   if (!ft232.init())
     return -1;
 
+  // --parallel for a panel wired to FT232 pins without backpack
+  if (argc > 1 && strcmp(argv[1], "--parallel") == 0)
+  {
+    ft232gpio::LCD1602Parallel lcd1602;
+    lcd1602.init(&ft232);
+    lcd1602.cursor(true);
+    lcd1602.blink(true);
+
+    show_lcd1602(lcd1602);
+
+    lcd1602.release();
+    ft232.release();
+    return 0;
+  }
+
   ft232gpio::I2C i2c;
   i2c.init(&ft232, 0x27);
 
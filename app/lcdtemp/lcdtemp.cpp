@@ -17,14 +17,14 @@
 #include <ft232gpio/ft232.h>
 #include <ft232gpio/i2c.h>
 #include <ft232gpio/lcd1602.h>
+#include <ft232gpio/onewire.h>
+#include <ft232gpio/ds18b20.h>
+#include <ft232gpio/metrics.h>
 
 #include <cstdio>
 #include <chrono>
 #include <ctime>
-#include <cstdlib>
-#include <iostream>
-#include <string>
-#include <fstream>
+#include <vector>
 
 #include <signal.h>
 #include <unistd.h>
@@ -32,29 +32,18 @@
 
 static bool _do_loop = true;
 
-enum class CPU
-{
-  ARCH_UNKNOWN = 0,
-  ARCH_X86_64 = 1,
-  ARCH_AARCH64 = 2,
-};
+// enclosure temperature from DS18B20 instead of CPU, when found
+static ft232gpio::DS18B20 *_ds18b20 = nullptr;
 
-static CPU _cpu_arch = CPU::ARCH_UNKNOWN;
+static ft232gpio::Metrics _metrics;
 
-void set_cpu_arch(void)
+// text of a panel field, written only when it changes
+struct Field
 {
-#ifdef __aarch64__
-  _cpu_arch = CPU::ARCH_AARCH64;
-#endif
-#ifdef __x86_64__
-  _cpu_arch = CPU::ARCH_X86_64;
-#endif
-  if (_cpu_arch == CPU::ARCH_UNKNOWN)
-  {
-    std::cerr << "Unknown CPU architecture" << std::endl;
-    std::abort();
-  }
-}
+  int32_t row;
+  int32_t col;
+  char text[17];
+};
 
 void signal_handler(int sig)
 {
@@ -76,70 +65,72 @@ void make_time(char *buff, int32_t leng)
   snprintf(buff, leng, "%02d:%02d:%02d", tl->tm_hour, tl->tm_min, tl->tm_sec);
 }
 
+bool make_temp_ds18b20(char *buff, int32_t leng)
+{
+  // conversion started in last loop is done by now, start next one after read
+  std::vector<int32_t> millis;
+  bool ok = _ds18b20->read(millis);
+  _ds18b20->convert();
+  if (not ok)
+    return false;
+
+  float fv = float(millis[0] / 100) / 10.0f;
+  snprintf(buff, leng, "%04.1f\xdf" "C", fv);
+  return true;
+}
+
 void make_temp(char *buff, int32_t leng)
 {
-  const char *path = nullptr;
-  switch (_cpu_arch)
+  if (_ds18b20 && make_temp_ds18b20(buff, leng))
+    return;
+
+  int32_t millic;
+  if (not _metrics.temperature(millic))
   {
-    case CPU::ARCH_AARCH64:
-      path = "/sys/class/thermal/thermal_zone0/temp";
-      break;
-    case CPU::ARCH_X86_64:
-      path = "/sys/devices/platform/coretemp.0/hwmon/hwmon3/temp1_input";
-      break;
+    snprintf(buff, leng, "--.-\xdf" "C");
+    return;
   }
-  std::ifstream ft(path, std::ios::in | std::ios::binary);
-
-  std::string line;
-  std::getline(ft, line);
-  long lv = atol(line.c_str()) / 100;
-  float fv = float(lv) / 10.0f;
-  snprintf(buff, leng, "%04.1f", fv);
+  float fv = float(millic / 100) / 10.0f;
+  snprintf(buff, leng, "%04.1f\xdf" "C", fv);
 }
 
-void make_freemem(char *buff, int32_t leng)
+// available memory and load average, fixed width so old text is overwritten
+void make_system(char *buff, int32_t leng)
 {
-  const char *path = "/proc/meminfo";
-  std::ifstream ft(path, std::ios::in | std::ios::binary);
-
-  std::string line;
-  std::getline(ft, line); // MemTotal
-  std::getline(ft, line); // MemFree
-  std::getline(ft, line); // MemAvailable:    4115664 kB
+  ft232gpio::MemInfo mem;
+  ft232gpio::LoadAvg load;
+  long mb = _metrics.meminfo(mem) ? long(mem.available_kb / 1024) : 0;
+  if (not _metrics.loadavg(load))
+    load = ft232gpio::LoadAvg();
+  snprintf(buff, leng, "%5ld MB  %5.2f", mb, load.one);
+}
 
-  const char *num = line.c_str() + 13;
-  char *dst = buff;
-  while (*num)
-  {
-    if (*num == ' ')
-      num++;
-    else
-      break;
-  }
-  strncpy(buff, num, leng);
-  long lv = atol(buff) / 1024;
-  snprintf(buff, leng, "%ld MB", lv);
+void update(ft232gpio::LCD1602 &lcd1602, Field &field, const char *text)
+{
+  if (strcmp(field.text, text) == 0)
+    return;
+  snprintf(field.text, sizeof(field.text), "%s", text);
+  lcd1602.move(field.row, field.col);
+  lcd1602.puts(field.text);
 }
 
 void show_lcd1602(ft232gpio::LCD1602 &lcd1602)
 {
-  char buff[260];
+  char buff[32];
+  Field temp = {0, 0, ""};
+  Field time = {0, 8, ""};
+  Field system = {1, 0, ""};
 
   while (_do_loop)
   {
-    make_temp(buff, 260);
-    lcd1602.move(0, 0);
-    lcd1602.puts(buff);
-    lcd1602.putch(0xdf);
-    lcd1602.putch('C');
+    make_temp(buff, sizeof(buff));
+    update(lcd1602, temp, buff);
 
-    make_time(buff, 260);
-    lcd1602.move(0, 8);
-    lcd1602.puts(buff);
+    make_time(buff, sizeof(buff));
+    update(lcd1602, time, buff);
 
-    make_freemem(buff, 260);
-    lcd1602.move(1, 0);
-    lcd1602.puts(buff);
+    make_system(buff, sizeof(buff));
+    update(lcd1602, system, buff);
 
     msleep(1000);
   }
@@ -148,7 +139,19 @@ void show_lcd1602(ft232gpio::LCD1602 &lcd1602)
 int main(int argc, char **argv)
 {
   signal(SIGINT, signal_handler);
-  set_cpu_arch();
+
+  // --warm to keep the panel contents on restart
+  // --ds18b20 for temperature from DS18B20 on TXD/RXD
+  bool warm = false;
+  bool ds18b20 = false;
+  for (int i = 1; i < argc; ++i)
+  {
+    warm = warm || strcmp(argv[i], "--warm") == 0;
+    ds18b20 = ds18b20 || strcmp(argv[i], "--ds18b20") == 0;
+  }
+
+  if (not _metrics.init())
+    printf("System metrics not available\r\n");
 
   ft232gpio::FT232 ft232;
   if (!ft232.init())
@@ -158,15 +161,43 @@ int main(int argc, char **argv)
   i2c.init(&ft232, 0x27);
 
   ft232gpio::LCD1602 lcd1602;
-  lcd1602.init(&i2c);
-  lcd1602.cursor(false);
-  lcd1602.blink(false);
+  if (warm)
+    lcd1602.attach(&i2c);
+  else
+  {
+    lcd1602.init(&i2c);
+    lcd1602.cursor(false);
+    lcd1602.blink(false);
+  }
+  printf("LCD ready in %u us\r\n", lcd1602.init_usecs());
+
+  ft232gpio::OneWire onewire;
+  ft232gpio::DS18B20 sensors;
+  if (ds18b20)
+  {
+    onewire.init(&ft232);
+    if (sensors.init(&onewire) && sensors.convert())
+    {
+      _ds18b20 = &sensors;
+      msleep(DS18B20_CONVERT_MSEC);
+    }
+    else
+      printf("DS18B20 not found, using CPU temperature\r\n");
+  }
 
   show_lcd1602(lcd1602);
 
+  if (ds18b20)
+  {
+    _ds18b20 = nullptr;
+    sensors.release();
+    onewire.release();
+  }
+
   lcd1602.release();
   i2c.release();
   ft232.release();
+  _metrics.release();
 
   return 0;
 }
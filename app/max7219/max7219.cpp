@@ -0,0 +1,80 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ft232gpio/ft232.h>
+#include <ft232gpio/spi.h>
+
+#include <unistd.h>
+
+// MAX7219 registers
+#define MAX7219_DIGIT0 0x01
+#define MAX7219_DECODE 0x09
+#define MAX7219_INTENSITY 0x0A
+#define MAX7219_SCANLIMIT 0x0B
+#define MAX7219_SHUTDOWN 0x0C
+#define MAX7219_TEST 0x0F
+
+void msleep(unsigned int msecs)
+{
+  //
+  usleep(msecs * 1000);
+}
+
+void reg(ft232gpio::SPI &spi, uint8_t addr, uint8_t value)
+{
+  uint8_t data[2] = {addr, value};
+  spi.write(data, 2);
+}
+
+int main(int argc, char **argv)
+{
+  ft232gpio::FT232 ft232;
+  if (!ft232.init())
+    return -1;
+
+  // MAX7219 only receives, DIN CLK LOAD on TXD RXD RTS
+  ft232gpio::SPI spi;
+  spi.pins(SPI_PIN_CS, SPI_PIN_SCK, SPI_PIN_MOSI, 0);
+  spi.init(&ft232, 0);
+
+  {
+    // one USB write for the whole setup
+    ft232gpio::FT232Batch batch(&ft232);
+    reg(spi, MAX7219_TEST, 0);
+    reg(spi, MAX7219_DECODE, 0);
+    reg(spi, MAX7219_SCANLIMIT, 7);
+    reg(spi, MAX7219_INTENSITY, 2);
+    reg(spi, MAX7219_SHUTDOWN, 1);
+  }
+
+  // diagonal moving across 8x8 matrix
+  for (int i = 0; i < 32; ++i)
+  {
+    {
+      ft232gpio::FT232Batch batch(&ft232);
+      for (int row = 0; row < 8; ++row)
+        reg(spi, MAX7219_DIGIT0 + row, 1 << ((row + i) % 8));
+    }
+    msleep(100);
+  }
+
+  reg(spi, MAX7219_SHUTDOWN, 0);
+
+  spi.release();
+  ft232.release();
+
+  return 0;
+}
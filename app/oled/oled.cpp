@@ -0,0 +1,82 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <ft232gpio/ft232.h>
+#include <ft232gpio/i2c.h>
+#include <ft232gpio/ssd1306.h>
+
+#include <cstdio>
+
+#include <signal.h>
+#include <unistd.h>
+
+static bool _do_loop = true;
+
+void signal_handler(int sig)
+{
+  printf("Ctrl+Break!\r\n");
+  _do_loop = false;
+}
+
+void show_oled(ft232gpio::SSD1306 &oled)
+{
+  oled.rect(0, 0, oled.width(), oled.height());
+  oled.text(4, 4, "FT232 GPIO");
+  oled.present();
+
+  // only the counter and the bar change, present() sends just those columns
+  uint32_t count = 0;
+  while (_do_loop)
+  {
+    char text[16];
+    snprintf(text, sizeof(text), "%6u", count);
+    oled.text(4, 20, text);
+
+    int32_t width = (count % 20) * 6;
+    oled.rect(4, 40, 120, 8, true, false);
+    oled.rect(4, 40, width, 8, true);
+
+    oled.present();
+    printf("present %u bytes\r\n", oled.present_bytes());
+
+    count++;
+    usleep(500 * 1000);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  signal(SIGINT, signal_handler);
+
+  ft232gpio::FT232 ft232;
+  if (!ft232.init())
+    return -1;
+
+  ft232gpio::I2C i2c;
+  i2c.init(&ft232, SSD1306_ADDR);
+
+  ft232gpio::SSD1306 oled;
+  oled.init(&i2c);
+
+  show_oled(oled);
+
+  oled.release();
+  i2c.release();
+  ft232.release();
+
+  return 0;
+}
@@ -15,32 +15,100 @@
  */
 
 #include <ft232gpio/ft232.h>
+#include <ft232gpio/capture.h>
+#include <ft232gpio/input.h>
 
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
+#include <signal.h>
 #include <unistd.h>
 
+static bool _do_loop = true;
+
+void signal_handler(int sig)
+{
+  printf("Ctrl+Break!\r\n");
+  _do_loop = false;
+}
+
 void msleep(unsigned int msecs)
 {
   //
   usleep(msecs * 1000);
 }
 
+// capture all pins to VCD, starting at first change of any pin or from
+// now when no pin changes for seconds. Ctrl+C ends it with a complete file.
+int capture(ft232gpio::FT232 &ft232, const char *path, uint32_t seconds)
+{
+  ft232gpio::CaptureTrigger trigger;
+  trigger.type = ft232gpio::CaptureTrigger::EDGE;
+  trigger.mask = 0xff;
+
+  ft232gpio::Capture capture;
+  uint64_t count = uint64_t(seconds) * ft232.sample_rate();
+  if (!capture.start(&ft232, path, 0xff, trigger, 0, count))
+    return -1;
+
+  printf("Capture %u seconds to %s\r\n", seconds, path);
+  auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+  bool waiting = true;
+  while (_do_loop && capture.running())
+  {
+    if (waiting && not capture.triggered() && std::chrono::steady_clock::now() >= timeout)
+    {
+      printf("No pin change, capture from now\r\n");
+      capture.stop();
+      if (!capture.start(&ft232, path, 0xff, ft232gpio::CaptureTrigger(), 0, count))
+        return -1;
+      waiting = false;
+    }
+    msleep(100);
+  }
+  capture.stop();
+
+  printf("Written %llu samples, dropped %llu\r\n", (unsigned long long)capture.written(),
+         (unsigned long long)capture.overruns());
+  return 0;
+}
+
 int main(int argc, char **argv)
 {
+  signal(SIGINT, signal_handler);
+
   ft232gpio::FT232 ft232;
 
   if (!ft232.init())
     return -1;
 
-  uint8_t data;
+  // read --capture out.vcd [seconds]
+  if (argc > 2 && strcmp(argv[1], "--capture") == 0)
+  {
+    int ret = capture(ft232, argv[2], argc > 3 ? atoi(argv[3]) : 10);
+    ft232.release();
+    return ret;
+  }
 
-  for (int i = 0; i < 100; ++i)
+  // print changes of all pins for 10 seconds
+  ft232gpio::InputWatcher watcher;
+  watcher.start(&ft232, 0xff);
+  printf("Data 0x%02x\r\n", watcher.state());
+
+  auto start = std::chrono::steady_clock::now();
+  auto end = start + std::chrono::seconds(10);
+  ft232gpio::InputEvent event;
+  while (_do_loop && std::chrono::steady_clock::now() < end)
   {
-    msleep(100);
-    ft232.read_data(&data);
-    printf("Data 0x%02x\r\n", data);
+    if (!watcher.wait(event, 100))
+      continue;
+    auto usecs = std::chrono::duration_cast<std::chrono::microseconds>(event.time - start);
+    printf("%8lld us pin 0x%02x %s\r\n", (long long)usecs.count(), event.pin,
+           event.level ? "high" : "low");
   }
+  watcher.stop();
 
   ft232.release();
 
@@ -0,0 +1,301 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <ft232gpio/ft232.h>
+#include <ft232gpio/ft232_sim.h>
+#include <ft232gpio/i2c.h>
+#include <ft232gpio/lcd1602.h>
+#include <ft232gpio/lcd1602_parallel.h>
+#include <ft232gpio/profile.h>
+#include <ft232gpio/sim_lcd.h>
+#include <ft232gpio/sim_tm1637.h>
+#include <ft232gpio/tm1637.h>
+#include <ft232gpio/tuner.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// finds the shortest bus timing that a device works with and saves it to
+// the profile that drivers load in init(). on hardware I2C devices and
+// TM1637 are checked by their acknowledge. HD44780 can not be read back
+// through the drivers, so its command waits are only tuned with --sim,
+// against the device model with the timing limits given. --serial gives
+// the serial of the adapter that the profile saved from --sim is for.
+
+static const char *_lines[2] = {"Hello World!", "ft232gpio 0123"};
+
+struct Options
+{
+  bool sim = false;
+  bool save = false;
+  uint32_t margin = 50;
+  uint32_t repeat = 4;
+  uint32_t rate = 0;
+  uint32_t clock_ns = 0; // bus clock low and high of the model
+  uint32_t exec_ns = 0;  // HD44780 command time of the model
+  const char *serial = nullptr; // adapter serial for --sim
+};
+
+static bool tune(ft232gpio::TimingTuner &tuner, const Options &options,
+                 const std::vector<ft232gpio::TuneParam> &params)
+{
+  tuner.margin(options.margin);
+  tuner.repeat(options.repeat);
+  bool ok = tuner.tune(params);
+  for (auto &param : params)
+    printf("  %-14s %u\n", param.name, *param.usecs);
+  printf("  %s after %u checks\n", ok ? "tuned" : "FAILED", tuner.checks());
+  return ok;
+}
+
+static bool tune_i2c(ft232gpio::I2C &i2c, const Options &options)
+{
+  ft232gpio::I2CTiming timing = ft232gpio::I2C_TIMING_DEFAULT;
+  ft232gpio::TimingTuner tuner([&] {
+    i2c.timing(timing);
+    return i2c.probe();
+  });
+
+  printf("i2c 0x%02x\n", i2c.addr());
+  if (not tune(tuner, options, {{"setup_usecs", &timing.setup_usecs},
+                                {"clock_usecs", &timing.clock_usecs}}))
+    return false;
+  i2c.timing(timing);
+  ft232gpio::timing_profiles().store(i2c.ft232()->serial(), i2c.addr(), timing);
+  return true;
+}
+
+static bool tune_lcd(ft232gpio::HD44780 &lcd, ft232gpio::HD44780Model &model,
+                     std::vector<ft232gpio::SimDevice *> devices, uint32_t addr,
+                     ft232gpio::FT232 &ft232, const Options &options)
+{
+  ft232gpio::LCDTiming timing = ft232gpio::LCD_TIMING_DEFAULT;
+  ft232gpio::TimingTuner tuner([&] {
+    lcd.timing(timing);
+    for (auto device : devices)
+      device->clear_violations();
+
+    lcd.clear();
+    lcd.move(0, 0);
+    lcd.puts(_lines[0]);
+    lcd.home();
+    lcd.move(1, 0);
+    lcd.puts(_lines[1]);
+
+    for (auto device : devices)
+    {
+      if (device->violation_count())
+        return false;
+    }
+    for (uint8_t row = 0; row < 2; ++row)
+    {
+      std::string expect = _lines[row];
+      expect.resize(lcd.cols(), ' ');
+      if (model.text(row) != expect)
+        return false;
+    }
+    return true;
+  });
+
+  printf("lcd 0x%02x\n", addr);
+  if (not tune(tuner, options, {{"nibble_usecs", &timing.nibble_usecs},
+                                {"cmd_usecs", &timing.cmd_usecs},
+                                {"clear_usecs", &timing.clear_usecs},
+                                {"home_usecs", &timing.home_usecs}}))
+    return false;
+  lcd.timing(timing);
+  ft232gpio::timing_profiles().store(ft232.serial(), addr, timing);
+  return true;
+}
+
+static bool tune_tm1637(ft232gpio::TM1637 &tm1637, ft232gpio::FT232 &ft232,
+                        const Options &options)
+{
+  ft232gpio::TM1637Timing timing = ft232gpio::TM1637_TIMING_DEFAULT;
+  ft232gpio::TimingTuner tuner([&] {
+    tm1637.timing(timing);
+    return tm1637.probe();
+  });
+
+  printf("tm1637 0x%02x\n", tm1637.pin_mask());
+  if (not tune(tuner, options, {{"clock_usecs", &timing.clock_usecs},
+                                {"hold_usecs", &timing.hold_usecs}}))
+    return false;
+  tm1637.timing(timing);
+  ft232gpio::timing_profiles().store(ft232.serial(), tm1637.pin_mask(), timing);
+  return true;
+}
+
+static int usage(const char *name)
+{
+  fprintf(stderr,
+          "usage: %s [--sim [--serial SERIAL]] [--save] [--margin PERCENT] [--repeat N]\n"
+          "          [--rate SPS] [--clock-ns N] [--exec-ns N]\n"
+          "          i2c ADDR | lcd1602 ADDR | lcd1602p | tm1637\n",
+          name);
+  return -1;
+}
+
+int main(int argc, char **argv)
+{
+  Options options;
+  const char *device = nullptr;
+  uint8_t addr = 0;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "--sim") == 0)
+      options.sim = true;
+    else if (strcmp(argv[i], "--save") == 0)
+      options.save = true;
+    else if (strcmp(argv[i], "--margin") == 0 && i + 1 < argc)
+      options.margin = strtoul(argv[++i], nullptr, 0);
+    else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+      options.repeat = strtoul(argv[++i], nullptr, 0);
+    else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc)
+      options.rate = strtoul(argv[++i], nullptr, 0);
+    else if (strcmp(argv[i], "--clock-ns") == 0 && i + 1 < argc)
+      options.clock_ns = strtoul(argv[++i], nullptr, 0);
+    else if (strcmp(argv[i], "--exec-ns") == 0 && i + 1 < argc)
+      options.exec_ns = strtoul(argv[++i], nullptr, 0);
+    else if (strcmp(argv[i], "--serial") == 0 && i + 1 < argc)
+      options.serial = argv[++i];
+    else if (device == nullptr)
+    {
+      device = argv[i];
+      if ((strcmp(device, "i2c") == 0 || strcmp(device, "lcd1602") == 0) && i + 1 < argc)
+        addr = strtoul(argv[++i], nullptr, 0);
+    }
+    else
+      return usage(argv[0]);
+  }
+  if (device == nullptr)
+    return usage(argv[0]);
+
+  bool is_i2c = strcmp(device, "i2c") == 0;
+  bool is_lcd1602 = strcmp(device, "lcd1602") == 0;
+  bool is_lcd1602p = strcmp(device, "lcd1602p") == 0;
+  bool is_tm1637 = strcmp(device, "tm1637") == 0;
+  if (not(is_i2c || is_lcd1602 || is_lcd1602p || is_tm1637) || ((is_i2c || is_lcd1602) && !addr))
+    return usage(argv[0]);
+  if (is_lcd1602p && not options.sim)
+  {
+    fprintf(stderr, "lcd1602p can only be tuned with --sim\n");
+    return -1;
+  }
+  if (options.serial && not options.sim)
+  {
+    fprintf(stderr, "--serial is only for --sim, the serial is read from the adapter\n");
+    return -1;
+  }
+  // profiles are looked up by the serial of the adapter, one saved for the
+  // simulated adapter would never be used
+  if (options.sim && options.save && options.serial == nullptr)
+  {
+    fprintf(stderr, "--sim --save needs --serial of the adapter to save for\n");
+    return -1;
+  }
+
+  // models with the limits given, attached only with --sim
+  ft232gpio::SimBusTiming i2c_limits = ft232gpio::SIM_TIMING_I2C;
+  ft232gpio::SimBusTiming tm1637_limits = ft232gpio::SIM_TIMING_TM1637;
+  ft232gpio::HD44780Timing lcd_limits = ft232gpio::SIM_TIMING_HD44780;
+  if (options.clock_ns)
+  {
+    for (auto limits : {&i2c_limits, &tm1637_limits})
+    {
+      limits->low_ns = limits->high_ns = options.clock_ns;
+      limits->start_hold_ns = limits->stop_setup_ns = options.clock_ns;
+    }
+  }
+  if (options.exec_ns)
+    lcd_limits.exec_ns = options.exec_ns;
+
+  ft232gpio::PCF8574Model pcf(addr, I2C_PIN_SCL, I2C_PIN_SDA, i2c_limits);
+  ft232gpio::HD44780Model lcd_pcf(ft232gpio::HD44780_PINS_PCF8574, ft232gpio::LCD_GEOMETRY_16x2,
+                                  lcd_limits);
+  ft232gpio::HD44780Model lcd_parallel(ft232gpio::HD44780_PINS_PARALLEL,
+                                       ft232gpio::LCD_GEOMETRY_16x2, lcd_limits);
+  ft232gpio::TM1637Model fnd(TM1637_PIN_CLOCK, TM1637_PIN_DIO, tm1637_limits);
+  pcf.on_port([&](uint8_t port, uint64_t nsecs) { lcd_pcf.input(port, nsecs); });
+
+  ft232gpio::FT232Sim sim;
+  ft232gpio::FT232 usb;
+  ft232gpio::FT232 &ft232 = options.sim ? static_cast<ft232gpio::FT232 &>(sim) : usb;
+  if (options.sim)
+  {
+    if (options.serial)
+      sim.serial_number(options.serial);
+    if (is_i2c || is_lcd1602)
+      sim.attach(&pcf);
+    else if (is_lcd1602p)
+      sim.attach(&lcd_parallel);
+    else
+      sim.attach(&fnd);
+  }
+  if (!ft232.init())
+    return -1;
+  if (options.rate && not ft232.set_sample_rate(options.rate))
+    return -1;
+  printf("adapter %s, %u samples/s\n", ft232.serial().empty() ? "-" : ft232.serial().c_str(),
+         ft232.sample_rate());
+
+  bool ok = true;
+  if (is_i2c || is_lcd1602)
+  {
+    ft232gpio::I2C i2c;
+    i2c.init(&ft232, addr);
+    ok = tune_i2c(i2c, options);
+    if (ok && is_lcd1602)
+    {
+      ft232gpio::LCD1602 lcd;
+      lcd.init(&i2c);
+      if (options.sim)
+        ok = tune_lcd(lcd, lcd_pcf, {&pcf, &lcd_pcf}, addr, ft232, options);
+      else
+        printf("lcd 0x%02x needs --sim, command waits are not changed\n", addr);
+      lcd.release();
+    }
+    i2c.release();
+  }
+  else if (is_lcd1602p)
+  {
+    ft232gpio::LCD1602Parallel lcd;
+    lcd.init(&ft232);
+    ok = tune_lcd(lcd, lcd_parallel, {&lcd_parallel}, lcd.pin_mask(), ft232, options);
+    lcd.release();
+  }
+  else
+  {
+    ft232gpio::TM1637 tm1637;
+    tm1637.init(&ft232);
+    ok = tune_tm1637(tm1637, ft232, options);
+    tm1637.release();
+  }
+
+  if (ok && options.save)
+  {
+    std::string path = ft232gpio::TimingProfiles::default_path();
+    ok = ft232gpio::timing_profiles().save(path);
+    printf("%s %s\n", ok ? "saved" : "failed to save", path.c_str());
+  }
+
+  ft232.release();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <ft232gpio/expander.h>
+#include <ft232gpio/ft232_sim.h>
+#include <ft232gpio/i2c.h>
+#include <ft232gpio/lcd1602.h>
+#include <ft232gpio/lcd1602_parallel.h>
+#include <ft232gpio/seg7.h>
+#include <ft232gpio/sim_lcd.h>
+#include <ft232gpio/sim_tm1637.h>
+#include <ft232gpio/tm1637.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// runs drivers against device models on a simulated adapter and checks
+// what the devices end up showing, and the bus timing on the way.
+// returns non zero on any mismatch or violation.
+
+static const char *_lines[2] = {"Hello World!", "ft232gpio 0123"};
+
+static int report(const char *name, const ft232gpio::SimDevice &device)
+{
+  for (auto &v : device.violations())
+    printf("  %s: %s\n", name, v.c_str());
+  if (device.violation_count() > device.violations().size())
+    printf("  %s: %u more\n", name, uint32_t(device.violation_count() - device.violations().size()));
+  return device.violation_count() ? 1 : 0;
+}
+
+static int check_lcd(const char *name, const ft232gpio::HD44780Model &lcd)
+{
+  int fails = 0;
+  for (uint8_t row = 0; row < 2; ++row)
+  {
+    std::string text = lcd.text(row);
+    std::string expect = _lines[row];
+    expect.resize(text.size(), ' ');
+    bool ok = text == expect;
+    printf("%s [%s] %s\n", name, text.c_str(), ok ? "ok" : "MISMATCH");
+    fails += ok ? 0 : 1;
+  }
+  return fails + report(name, lcd);
+}
+
+static int verify_lcd1602(void)
+{
+  ft232gpio::FT232Sim sim;
+  ft232gpio::PCF8574Model pcf(0x27);
+  ft232gpio::HD44780Model lcd(ft232gpio::HD44780_PINS_PCF8574);
+  pcf.on_port([&](uint8_t port, uint64_t nsecs) { lcd.input(port, nsecs); });
+  sim.attach(&pcf);
+  if (!sim.init())
+    return 1;
+
+  ft232gpio::I2C i2c;
+  ft232gpio::LCD1602 lcd1602;
+  i2c.init(&sim, 0x27);
+  lcd1602.init(&i2c);
+  for (uint8_t row = 0; row < 2; ++row)
+  {
+    lcd1602.move(row, 0);
+    lcd1602.puts(_lines[row]);
+  }
+
+  int fails = check_lcd("lcd1602", lcd) + report("pcf8574", pcf);
+  lcd1602.release();
+  i2c.release();
+  sim.release();
+  return fails;
+}
+
+static int verify_lcd1602_parallel(void)
+{
+  ft232gpio::FT232Sim sim;
+  ft232gpio::HD44780Model lcd(ft232gpio::HD44780_PINS_PARALLEL);
+  sim.attach(&lcd);
+  if (!sim.init())
+    return 1;
+
+  ft232gpio::LCD1602Parallel lcd1602;
+  lcd1602.init(&sim);
+  for (uint8_t row = 0; row < 2; ++row)
+  {
+    lcd1602.move(row, 0);
+    lcd1602.puts(_lines[row]);
+  }
+
+  int fails = check_lcd("lcd1602_parallel", lcd);
+  lcd1602.release();
+  sim.release();
+  return fails;
+}
+
+static int verify_expander(void)
+{
+  ft232gpio::FT232Sim sim;
+  ft232gpio::PCF8574Model pcf(PCF8574_ADDR);
+  pcf.inputs(0xA5);
+  sim.attach(&pcf);
+  if (!sim.init())
+    return 1;
+
+  // inputs are written high, P0 is driven low and reads low
+  ft232gpio::I2C i2c;
+  ft232gpio::Expander expander;
+  i2c.init(&sim, PCF8574_ADDR);
+  expander.init(&i2c);
+  expander.inputs(0xF0);
+  expander.write(0x0F, 0x0E);
+
+  uint16_t value = 0;
+  bool ok = expander.read(value) && value == (0xA5 & 0xFE) && pcf.port() == 0xFE;
+  printf("expander [%02X] port %02X %s\n", value, pcf.port(), ok ? "ok" : "MISMATCH");
+
+  // no device at the address
+  ft232gpio::I2C other;
+  ft232gpio::Expander absent;
+  other.init(&sim, PCF8574_ADDR + 1);
+  absent.init(&other);
+  bool none = not absent.read(value);
+  printf("expander absent %s\n", none ? "ok" : "MISMATCH");
+
+  int fails = (ok ? 0 : 1) + (none ? 0 : 1) + report("pcf8574", pcf);
+  absent.release();
+  other.release();
+  expander.release();
+  i2c.release();
+  sim.release();
+  return fails;
+}
+
+static int verify_tm1637(void)
+{
+  ft232gpio::FT232Sim sim;
+  ft232gpio::TM1637Model fnd;
+  sim.attach(&fnd);
+  if (!sim.init())
+    return 1;
+
+  ft232gpio::TM1637 tm1637;
+  tm1637.init(&sim);
+  uint8_t data[4] = {ft232gpio::seg7_char('1'), ft232gpio::seg7_char('2'),
+                     ft232gpio::seg7_char('3'), ft232gpio::seg7_char('4')};
+  tm1637.digits(data, true);
+  tm1637.bright(5);
+
+  uint8_t expect[4] = {data[0], uint8_t(data[1] | TM1637_DBIT_COLON), data[2], data[3]};
+  bool ok = memcmp(fnd.segments(), expect, sizeof(expect)) == 0 && fnd.bright() == 5;
+  printf("tm1637 [%02X %02X %02X %02X] bright %u %s\n", fnd.segments()[0], fnd.segments()[1],
+         fnd.segments()[2], fnd.segments()[3], fnd.bright(), ok ? "ok" : "MISMATCH");
+
+  int fails = (ok ? 0 : 1) + report("tm1637", fnd);
+  tm1637.release();
+  sim.release();
+  return fails;
+}
+
+int main(int argc, char **argv)
+{
+  int fails = 0;
+
+  fails += verify_lcd1602();
+  fails += verify_lcd1602_parallel();
+  fails += verify_expander();
+  fails += verify_tm1637();
+
+  printf("%s\n", fails ? "FAILED" : "passed");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_CAPTURE_H__
+#define __FT232GPIO_CAPTURE_H__
+
+#include "ft232.h"
+#include "ring.h"
+#include "vcd.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#define CAPTURE_BLOCK 4096 // samples in one ring entry
+#define CAPTURE_RING 256   // ring entries, 1MB
+
+namespace ft232gpio
+{
+
+struct CaptureTrigger
+{
+  enum Type
+  {
+    NONE,    // from start
+    RISING,  // pin in mask goes high
+    FALLING, // pin in mask goes low
+    EDGE,    // any pin in mask changes
+    PATTERN, // pins in mask equal value
+  };
+  Type type = NONE;
+  uint8_t mask = 0x00;
+  uint8_t value = 0x00;
+};
+
+/**
+ * Logic analyzer. A reader thread reads pin samples from the adapter into a
+ * lock-free ring, a writer thread checks the trigger and writes samples to
+ * a VCD file. When the ring is full samples are read and dropped to keep
+ * the adapter from stalling, they are counted as overrun and the VCD time
+ * still advances over them.
+ */
+class Capture
+{
+public:
+  Capture() = default;
+  virtual ~Capture();
+
+public:
+  // pins are inputs while capturing. rate 0 keeps the sample rate of FT232.
+  // count is samples to write after the trigger, 0 until stop()
+  bool start(FT232 *ft232, const char *path, uint8_t pins, const CaptureTrigger &trigger = {},
+             uint32_t rate = 0, uint64_t count = 0);
+  void stop(void);
+
+public:
+  bool running(void) const { return _running; }
+  bool triggered(void) const { return _triggered; }
+  uint64_t written(void) const { return _written; }  // samples written to VCD
+  uint64_t overruns(void) const { return _overruns; } // samples dropped
+
+private:
+  struct Block
+  {
+    uint64_t index;
+    uint32_t count;
+    uint8_t data[CAPTURE_BLOCK];
+  };
+
+  void read_loop(void);
+  void write_loop(void);
+  void write_block(const Block &block);
+  int64_t trigger(const Block &block);
+
+private:
+  FT232 *_ft232 = nullptr;
+  uint8_t _pins = 0x00;
+  uint8_t _inputs = 0x00; // of FT232 before start
+  uint32_t _rate = 0;     // of FT232 before start, 0 when not changed
+  CaptureTrigger _trigger;
+  uint64_t _count = 0;
+
+  VCDWriter _vcd;
+  std::unique_ptr<RingQueue<Block, CAPTURE_RING>> _ring;
+
+  std::thread _reader;
+  std::thread _writer;
+  std::atomic<bool> _running{false};
+  std::atomic<bool> _reading{false};
+  std::atomic<bool> _triggered{false};
+  std::atomic<uint64_t> _written{0};
+  std::atomic<uint64_t> _overruns{0};
+
+  // writer thread only
+  uint8_t _prev = 0x00;
+  bool _has_prev = false;
+  uint64_t _trigger_index = 0;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_CAPTURE_H__
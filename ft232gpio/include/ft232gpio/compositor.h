@@ -0,0 +1,75 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_COMPOSITOR_H__
+#define __FT232GPIO_COMPOSITOR_H__
+
+#include "ft232.h"
+
+#include <functional>
+#include <vector>
+
+namespace ft232gpio
+{
+
+/**
+ * Drives devices on different pins at the same time. Each lane records the
+ * waveform of driver calls on its own pins, run() merges the lanes sample by
+ * sample into one stream and sends it in one transfer. The stream is as long
+ * as the longest lane, shorter lanes hold their last sample.
+ *
+ * Lanes may only write, driver calls that read pins such as key scan flush
+ * the recording and must not be used in a lane.
+ *
+ * Recording updates the state that drivers keep of their devices, eg. the
+ * segments of TM1637 or DDRAM of HD44780, as if it was sent. run() sends
+ * the lanes. clear() of lanes that were not run sends the driver state
+ * with FT232::replay(), so devices and drivers agree again.
+ */
+class FT232Compositor
+{
+public:
+  explicit FT232Compositor(FT232 *ft232) : _ft232(ft232) {}
+  virtual ~FT232Compositor() = default;
+
+public:
+  // records what send() writes, only pins in mask are kept. lanes must not
+  // share pins.
+  bool lane(uint8_t mask, std::function<void(void)> send);
+  bool run(void);
+  // drops the lanes, replays the drivers when the lanes were not run
+  void clear(void);
+
+public:
+  size_t lanes(void) const { return _lanes.size(); }
+  size_t samples(void) const; // length of the merged stream
+
+private:
+  struct Lane
+  {
+    uint8_t mask;
+    std::vector<uint8_t> samples;
+  };
+
+  FT232 *_ft232;
+  uint8_t _used = 0x00;
+  std::vector<Lane> _lanes;
+  bool _pending = false; // lanes recorded and not run
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_COMPOSITOR_H__
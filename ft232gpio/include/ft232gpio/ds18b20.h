@@ -0,0 +1,70 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_DS18B20_H__
+#define __FT232GPIO_DS18B20_H__
+
+#include "onewire.h"
+
+#include <climits>
+#include <vector>
+
+#define DS18B20_FAMILY 0x28
+
+#define DS18B20_CONVERT_T 0x44
+#define DS18B20_READ_SCRATCHPAD 0xBE
+
+#define DS18B20_CONVERT_MSEC 750 // 12 bit resolution
+#define DS18B20_INVALID INT32_MIN
+
+namespace ft232gpio
+{
+
+/**
+ * DS18B20 temperature sensors on one 1-Wire bus, powered from VDD.
+ * convert() starts all sensors at once, read() reads all scratchpads in one
+ * transfer. Temperatures are in 1/1000 degree C.
+ */
+class DS18B20
+{
+public:
+  DS18B20() = default;
+  virtual ~DS18B20() = default;
+
+public:
+  // searches the sensors on the bus
+  bool init(OneWire *onewire);
+  void release(void);
+
+  bool convert(void);
+  // DS18B20_INVALID for a sensor that did not answer, false if any
+  bool read(std::vector<int32_t> &millis);
+  // convert, wait and read
+  bool measure(std::vector<int32_t> &millis);
+
+public:
+  size_t count(void) const { return _roms.size(); }
+  uint64_t rom(size_t index) const { return _roms[index]; }
+
+private:
+  OneWire *_onewire = nullptr;
+  std::vector<uint64_t> _roms;
+  std::vector<uint8_t> _scratch;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_DS18B20_H__
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_EVENT_H__
+#define __FT232GPIO_EVENT_H__
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace ft232gpio
+{
+
+/**
+ * Queue of events from a polling thread to the application.
+ * Oldest events are dropped when the queue is full, so a slow reader sees
+ * the latest state instead of blocking the poller.
+ */
+template <typename T> class EventQueue
+{
+public:
+  explicit EventQueue(size_t limit = 64) : _limit(limit) {}
+
+public:
+  void push(const T &event)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_events.size() >= _limit)
+      {
+        _events.pop_front();
+        _dropped++;
+      }
+      _events.push_back(event);
+    }
+    _cv.notify_one();
+  }
+
+  bool poll(T &event)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return pop(event);
+  }
+
+  bool wait(T &event, uint32_t timeout_ms)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return !_events.empty(); });
+    return pop(event);
+  }
+
+  uint32_t dropped(void)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _dropped;
+  }
+
+private:
+  bool pop(T &event)
+  {
+    if (_events.empty())
+      return false;
+    event = _events.front();
+    _events.pop_front();
+    return true;
+  }
+
+private:
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::deque<T> _events;
+  size_t _limit;
+  uint32_t _dropped = 0;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_EVENT_H__
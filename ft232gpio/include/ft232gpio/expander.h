@@ -0,0 +1,89 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_EXPANDER_H__
+#define __FT232GPIO_EXPANDER_H__
+
+#include "i2c.h"
+
+#include <vector>
+
+// I2C address with A2~A0 low, set the address of I2C to these or above
+#define PCF8574_ADDR 0x20
+#define PCF8574A_ADDR 0x38
+#define PCF8575_ADDR 0x20
+
+namespace ft232gpio
+{
+
+/**
+ * PCF8574 (8 bits) and PCF8575 (16 bits) quasi-bidirectional I/O expander.
+ * The port is kept in a shadow register and every change is one I2C write.
+ * The expander latches its port at the acknowledge of each data byte, so a
+ * sequence of port values is sent as one write, one step per byte.
+ * Pins are inputs when written high, pins in inputs() are always written
+ * high so set/clear of other pins keep them readable. Like LCD1602, acks
+ * of writes are not checked as I2C does not read the bus back by default,
+ * read() reads the bus in synchronous bitbang.
+ */
+class Expander
+{
+public:
+  explicit Expander(int32_t bits = 8);
+  virtual ~Expander() = default;
+
+public:
+  bool init(I2C *i2c, uint16_t port = 0xFFFF);
+  void release(void);
+
+public:
+  bool initialized(void) { return _initalized; }
+  int32_t bits(void) const { return _bytes * 8; }
+  uint16_t port(void) const { return _port; } // shadow of the last write
+  void inputs(uint16_t mask);
+
+public:
+  // each writes the port once, only if it changes
+  void write(uint16_t value);
+  void write(uint16_t mask, uint16_t value);
+  void set(uint16_t mask) { write(mask, mask); }
+  void clear(uint16_t mask) { write(mask, 0); }
+  void toggle(uint16_t mask) { write(mask, ~_port); }
+
+  // port values in one I2C write, each held for hold_usecs at least
+  void sequence(const uint16_t *values, uint32_t count, uint32_t hold_usecs = 0);
+
+  // reads the pins, pins driven low by the expander read as 0.
+  // false when the expander did not answer
+  bool read(uint16_t &value);
+
+private:
+  bool send(const uint16_t *values, uint32_t count, uint32_t hold_usecs);
+  void replay(void);
+
+private:
+  I2C *_i2c = nullptr;
+  bool _initalized = false;
+  int32_t _bytes = 1;
+  uint16_t _port = 0xFFFF;
+  uint16_t _inputs = 0x0000;
+  FT232Replay _replay;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_EXPANDER_H__
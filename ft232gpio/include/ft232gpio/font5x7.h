@@ -0,0 +1,44 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_FONT5X7_H__
+#define __FT232GPIO_FONT5X7_H__
+
+#include <cstdint>
+
+#define FONT5X7_FIRST 0x20 // ' '
+#define FONT5X7_LAST 0x7E  // '~'
+#define FONT5X7_WIDTH 5
+
+namespace ft232gpio
+{
+
+// 5 columns per glyph, bit 0 is the top row, as SSD1306 pages are laid out
+extern const uint8_t font5x7[FONT5X7_LAST - FONT5X7_FIRST + 1][FONT5X7_WIDTH];
+
+// characters out of range are shown as '?'
+inline const uint8_t *font5x7_glyph(char c)
+{
+  uint8_t ch = static_cast<uint8_t>(c);
+  if (ch < FONT5X7_FIRST || ch > FONT5X7_LAST)
+    ch = '?';
+  return font5x7[ch - FONT5X7_FIRST];
+}
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_FONT5X7_H__
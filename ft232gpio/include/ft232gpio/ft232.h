@@ -17,13 +17,38 @@
 #ifndef __FT232GPIO_FT232_H__
 #define __FT232GPIO_FT232_H__
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <ftdi.h>
 
 namespace ft232gpio
 {
 
+class Trace;
+
+// asynchronous write in flight, from write_submit()
+struct FT232Transfer
+{
+  struct ftdi_transfer_control *control = nullptr; // nullptr when submit failed
+  uint32_t connection = 0;                         // device open it was submitted to
+};
+
+// counters of USB writes, bytes are samples
+struct FT232Stats
+{
+  uint64_t transfers = 0;
+  uint64_t bytes = 0;
+};
+
 class FT232
 {
 public:
@@ -36,10 +61,190 @@ public:
 
 public:
   bool write_data(const uint8_t *buf, int size);
+  // writes one sample that changes only the pins in mask, other pins keep
+  // their last value so devices on other pins are not disturbed
+  bool write_pins(uint8_t mask, uint8_t value);
   bool read_data(uint8_t *buf);
+  // writes in synchronous bitbang mode, in[i] gets the pins sampled while
+  // out[i] is sent. pins not in outputs are inputs during the transfer.
+  // long transfers pause between chunks, breaks are sorted offsets where a
+  // pause is allowed when timing matters.
+  bool transfer(const uint8_t *out, uint8_t *in, int size, uint8_t outputs,
+                const std::vector<uint32_t> *breaks = nullptr);
+  // pins that are never driven, eg. a line that a device pulls low.
+  // all pins are outputs by default.
+  bool inputs(uint8_t mask);
+  uint8_t inputs(void) const { return 0xFF & ~_outputs; }
+
+public:
+  // asynchronous write for streams that keep a few transfers in flight.
+  // buf must stay unchanged until write_wait() returns. other writes queue
+  // up behind the transfers in flight. write_wait() does not hold the port
+  // lock while it waits. when the device is lost, transfers in flight are
+  // finished before it is closed and write_wait() returns false for them.
+  FT232Transfer write_submit(uint8_t *buf, int size);
+  bool write_wait(const FT232Transfer &transfer);
+
+public:
+  // in asynchronous bitbang the adapter keeps sampling all pins at the
+  // sample rate into its receive buffer. read_samples() returns the samples
+  // since the last call or purge_samples(), -1 on error.
+  int read_samples(uint8_t *buf, int size);
+  bool purge_samples(void);
+
+public:
+  // batch collects writes and delays and sends them as one USB transfer at
+  // the outermost batch_end(). delays in a batch are padded with samples of
+  // the bitbang clock instead of sleeping. a batch holds the port lock, so
+  // drivers use one per public operation.
+  void batch_begin(void);
+  bool batch_end(void);
+  void delay(uint32_t usecs);
+  uint32_t sample_rate(void) const;
+  // changes the bitbang clock, delays of drivers follow it
+  bool set_sample_rate(uint32_t rate);
+  uint32_t samples(uint32_t usecs) const; // samples to hold for usecs, at least 1
+  uint8_t port(void) const { return _port; } // last sample, read with a batch held
+
+public:
+  // record is a batch that keeps its samples instead of sending them, for
+  // waveforms that are prepared once and sent later with write_data().
+  // nothing is sent, the port is left as it was before record_begin().
+  void record_begin(void);
+  std::vector<uint8_t> record_end(void);
+
+public:
+  // when a transfer fails the device is closed and reopened in background
+  // with backoff. replay functions run in one batch right after reopen, in
+  // the order they were added, with the port lock held.
+  bool connected(void) const { return _connected; }
+  // serial number of the adapter, empty when it has none
+  const std::string &serial(void) const { return _serial; }
+  int32_t add_replay(std::function<void(void)> replay);
+  void remove_replay(int32_t id);
+  // runs the replay functions in one batch, as after reconnect, so devices
+  // show what their drivers last recorded
+  bool replay(void);
+
+public:
+  const FT232Stats &stats(void) const { return _stats; }
+  void reset_stats(void) { _stats = FT232Stats(); }
+  // every USB write also goes to the trace, nullptr to stop
+  void tap(Trace *trace);
+
+protected:
+  // USB access through libftdi, a simulated adapter overrides these.
+  // called with the port lock held, except usb_done() from write_wait().
+  virtual bool usb_init(void);
+  virtual void usb_deinit(void);
+  virtual bool usb_open(void);
+  virtual void usb_close(void);
+  virtual bool usb_mode(uint8_t outputs, uint8_t mode);
+  virtual bool usb_baudrate(uint32_t baudrate);
+  virtual int usb_write(const uint8_t *buf, int size);
+  virtual struct ftdi_transfer_control *usb_submit(uint8_t *buf, int size);
+  virtual int usb_done(struct ftdi_transfer_control *control);
+  virtual int usb_read(uint8_t *buf, int size);
+  virtual bool usb_purge(void);
+  virtual int usb_pins(uint8_t *pins);
+  virtual const char *usb_error(void);
+  virtual std::string usb_serial(void);
+
+private:
+  bool open(void);
+  void close(void);
+  bool flush(void);
+  void emitted(const uint8_t *buf, size_t size);
+  void lost(void);
+  void reconnect(void);
 
 private:
   struct ftdi_context *_ftdi = nullptr;
+  bool _usb_ready = false;
+  std::string _serial;
+  FT232Stats _stats;
+  Trace *_tap = nullptr;
+
+  std::recursive_mutex _lock;
+  uint32_t _batch_depth = 0;
+  std::vector<uint8_t> _batch;
+  uint8_t _port = 0x00; // last sample written
+  uint8_t _outputs = 0xFF; // direction of pins in bitbang mode
+  uint32_t _baudrate;
+  std::vector<std::pair<size_t, uint8_t>> _records; // batch offset and port at record_begin
+
+  std::atomic<bool> _connected{false};
+  uint32_t _connection = 0; // counts closes, transfers of older ones are done
+  std::vector<struct ftdi_transfer_control *> _submitted; // in flight, in order
+  std::mutex _wait_mutex;
+  std::condition_variable _wait_cv;
+  uint32_t _waiting = 0; // write_wait() in usb_done(), guarded by _wait_mutex
+  std::thread _reconnect_thread;
+  std::mutex _reconnect_mutex;
+  std::condition_variable _reconnect_cv;
+  bool _reconnect_stop = false;
+  bool _reconnecting = false; // reconnect thread is running, guarded by _lock
+
+  std::map<int32_t, std::function<void(void)>> _replays;
+  int32_t _replay_id = 0;
+};
+
+// FT232Batch keeps a batch for the scope
+class FT232Batch
+{
+public:
+  explicit FT232Batch(FT232 *ft232) : _ft232(ft232) { _ft232->batch_begin(); }
+  ~FT232Batch() { end(); }
+
+  FT232Batch(const FT232Batch &) = delete;
+  FT232Batch &operator=(const FT232Batch &) = delete;
+
+public:
+  // ends the batch before the scope does, false when the transfer failed.
+  // in a nested batch nothing is sent yet and it is true.
+  bool end(void)
+  {
+    if (_ft232)
+      _ok = _ft232->batch_end();
+    _ft232 = nullptr;
+    return _ok;
+  }
+
+private:
+  FT232 *_ft232;
+  bool _ok = true;
+};
+
+// FT232Replay keeps a replay function registered until remove() or the
+// owner is destroyed, the adapter must outlive it
+class FT232Replay
+{
+public:
+  FT232Replay() = default;
+  ~FT232Replay() { remove(); }
+
+  FT232Replay(const FT232Replay &) = delete;
+  FT232Replay &operator=(const FT232Replay &) = delete;
+
+public:
+  // replaces a function added before, so init after attach adds one only
+  void add(FT232 *ft232, std::function<void(void)> replay)
+  {
+    remove();
+    _id = ft232->add_replay(std::move(replay));
+    _ft232 = ft232;
+  }
+
+  void remove(void)
+  {
+    if (_ft232)
+      _ft232->remove_replay(_id);
+    _ft232 = nullptr;
+  }
+
+private:
+  FT232 *_ft232 = nullptr;
+  int32_t _id = 0;
 };
 
 } // namespace ft232gpio
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_FT232_SIM_H__
+#define __FT232GPIO_FT232_SIM_H__
+
+#include "ft232.h"
+#include "sim_device.h"
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ft232gpio
+{
+
+/**
+ * FT232 without an adapter, for benchmarks and device models.
+ * Samples written go to the sink instead of USB and take no time, the bus
+ * time is what they would take at the sample rate. In synchronous bitbang
+ * the pins read back are what respond() makes of the sample before, the
+ * sample itself by default. Asynchronous sample reads return nothing.
+ */
+class FT232Sim : public FT232
+{
+public:
+  FT232Sim() = default;
+  virtual ~FT232Sim();
+
+public:
+  // every sample written, in order
+  void sink(std::function<void(const uint8_t *, int)> sink) { _sink = std::move(sink); }
+  // pins read while a sample is on the port
+  void respond(std::function<uint8_t(uint8_t sample)> respond) { _respond = std::move(respond); }
+  // device models that see every sample written, after the sink. pins
+  // they pull low are read back in synchronous bitbang
+  void attach(SimDevice *device) { _devices.push_back(device); }
+  // serial number of the adapter, for timing profiles
+  void serial_number(const char *serial) { _serial = serial; }
+  // writes and open fail while unplugged, to exercise reconnect and replay
+  void unplug(bool unplugged) { _unplugged = unplugged; }
+
+  // time on the wire of the samples written since reset_stats()
+  uint64_t bus_usecs(void) const;
+
+protected:
+  bool usb_init(void) override { return true; }
+  void usb_deinit(void) override {}
+  bool usb_open(void) override { return not _unplugged; }
+  void usb_close(void) override {}
+  bool usb_mode(uint8_t outputs, uint8_t mode) override;
+  bool usb_baudrate(uint32_t baudrate) override { return not _unplugged; }
+  int usb_write(const uint8_t *buf, int size) override;
+  struct ftdi_transfer_control *usb_submit(uint8_t *buf, int size) override;
+  int usb_done(struct ftdi_transfer_control *control) override { return 0; }
+  int usb_read(uint8_t *buf, int size) override;
+  bool usb_purge(void) override;
+  int usb_pins(uint8_t *pins) override;
+  const char *usb_error(void) override { return "simulated"; }
+  std::string usb_serial(void) override { return _serial; }
+
+private:
+  uint8_t read_pins(uint8_t sample) const;
+
+private:
+  std::function<void(const uint8_t *, int)> _sink;
+  std::function<uint8_t(uint8_t)> _respond;
+  std::vector<SimDevice *> _devices;
+  std::string _serial = "sim";
+  bool _unplugged = false;
+  uint8_t _mode = BITMODE_RESET;
+  uint8_t _last = 0xFF;    // last sample written
+  std::deque<uint8_t> _rx; // synchronous bitbang read back
+  int _token = 0;          // usb_submit() result, never looked at
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_FT232_SIM_H__
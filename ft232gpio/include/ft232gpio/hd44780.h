@@ -0,0 +1,175 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_HD44780_H__
+#define __FT232GPIO_HD44780_H__
+
+#include "lcd1602_def.h"
+#include "lcd_geometry.h"
+#include "ft232.h"
+
+#include <chrono>
+#include <string>
+
+namespace ft232gpio
+{
+
+// waits after HD44780 commands in usecs, initialization keeps its own
+struct LCDTiming
+{
+  uint32_t nibble_usecs; // after each nibble
+  uint32_t cmd_usecs;    // after an instruction or data, 37us by spec
+  uint32_t clear_usecs;  // after clear display
+  uint32_t home_usecs;   // after return home, 1.52ms by spec
+};
+
+static constexpr LCDTiming LCD_TIMING_DEFAULT = {10, 50, 5000, 1600};
+
+/**
+ * Command layer of HD44780 character LCD in 4bit mode. Transports write
+ * nibbles to the bus, eg. a PCF8574 backpack or FT232 pins directly.
+ */
+class HD44780
+{
+public:
+  HD44780();
+  explicit HD44780(const LCDGeometry &geometry);
+  virtual ~HD44780() = default;
+
+public:
+  bool initialized(void) { return _initalized; }
+  const LCDGeometry &geometry(void) const { return _geometry; }
+  uint32_t init_usecs(void) const { return _init_usecs; } // last init/attach time
+  uint8_t rows(void) const { return _geometry.rows; }
+  uint8_t cols(void) const { return _geometry.cols; }
+
+  void timing(const LCDTiming &timing) { _timing = timing; }
+  const LCDTiming &timing(void) const { return _timing; }
+
+public:
+  void clear();
+  void home();
+  void display(bool enable); // display on/off
+  void cursor(bool enable);  // cursor on/off
+  void blink(bool enable);   // blinking on/off
+  void puts(const char *str);
+  void putch(uint8_t ch);
+  void move(uint8_t row, uint8_t col);
+  void cgram(uint8_t ch, uint8_t *data, uint32_t leng);
+
+public:
+  // marquee scrolls text on a row to the left, one column per step, by
+  // rewriting the visible columns of the row each step.
+  // with shift, text up to 40 characters on a panel of 1 or 2 rows is loaded
+  // into DDRAM once and scrolled with display shift commands instead. this
+  // overwrites all 40 columns of the row and scrolls the other row too, so
+  // use it only when the rest of the panel is blank or may move.
+  void marquee(uint8_t row, const char *text, uint32_t interval_ms = 300, bool shift = false);
+  bool marquee_tick(void); // step if interval elapsed, returns true if stepped
+  void marquee_step(void);
+  void marquee_run(uint32_t steps);
+  void marquee_stop(void);
+
+public:
+  // double buffer draws into the hidden columns cols ~ 2*cols-1 of DDRAM and
+  // page_flip() shows it with return home or cols display shift commands.
+  // needs rows <= 2 and cols <= 20. move() targets the hidden page while
+  // enabled; redraw every field of a page before a flip.
+  // needs a transport that sends the shifts well within a frame, so the page
+  // appears at once. behind a PCF8574 each shift takes a few ms and the flip
+  // would visibly scroll, enable returns false there.
+  bool double_buffer(bool enable);
+  void page_flip(void);
+
+protected:
+  virtual FT232 *ft232(void) = 0;
+  // writes nibble to DB7~DB4 with EN pulse, then waits delay usecs
+  virtual void write_4bits(uint8_t nibble, bool rs, uint32_t delay) = 0;
+  // writes bytes as two nibbles each, paced for the 37us of a command
+  virtual void write_run(const uint8_t *data, uint32_t count, bool rs) = 0;
+  // true when a run of cols commands takes well under a frame
+  virtual bool fast_commands(void) const { return false; }
+
+protected:
+  // transports call these from init, attach and release with the bus ready
+  bool begin(void);
+  // resyncs 4bit mode with short delays and restores display flags without
+  // clearing, so the current text stays
+  bool resume(bool cursor, bool blink);
+  void end(void);
+  void wait(uint32_t usecs);
+  // default timing, or the profile of the adapter and addr if there is one
+  void load_timing(uint32_t addr);
+
+protected:
+  bool _back_light = false;
+
+private:
+  void function_set(uint8_t data);
+  void cursor_set(uint8_t data);
+  void display_set(void);
+  void entrymode_set(uint8_t data);
+  void putc(const char c);
+  void marquee_window(void);
+
+private:
+  void init_4bit(uint32_t delay_first, uint32_t delay);
+  void send_data(uint8_t data);
+  void send_ctrl(uint8_t data);
+  void send_ctrls(const uint8_t *data, uint32_t count);
+  void send_run(const uint8_t *data, uint32_t count, bool rs);
+
+private:
+  void track_ctrl(uint8_t cmd);
+  void track_data(uint8_t data);
+  static uint8_t ddram_next(uint8_t ac);
+  void replay(void);
+
+private:
+  bool _initalized = false;
+  uint32_t _init_usecs = 0;
+  LCDGeometry _geometry = LCD_GEOMETRY_16x2;
+  LCDTiming _timing = LCD_TIMING_DEFAULT;
+
+  bool _display = false;
+  bool _cursor = false;
+  bool _blink = false;
+
+  // marquee
+  std::string _marquee_text;
+  uint8_t _marquee_row = 0;
+  uint32_t _marquee_pos = 0;
+  bool _marquee_shift = false; // true for display shift, false for window rewrite
+  std::chrono::microseconds _marquee_interval{0};
+  std::chrono::steady_clock::time_point _marquee_next;
+
+  // double buffer
+  bool _double_buffer = false;
+  uint8_t _page_front = 0; // page shown, 0 at column 0 and 1 at column cols
+
+  // last known controller state for replay, sized by HD44780 memory
+  uint8_t _ddram[2][LCD_DDRAM_LINE_COLS];
+  uint8_t _cgram[64] = {0};
+  uint8_t _cgram_used = 0; // bit per character written
+  uint8_t _ac = 0;         // address counter
+  bool _ac_cgram = false;  // address counter points CGRAM
+  uint8_t _shift = 0;      // display shift to the left
+  FT232Replay _replay;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_HD44780_H__
@@ -19,9 +19,22 @@
 
 #include "ft232.h"
 
+// default pins
+#define I2C_PIN_SCL 0x08 // CTS of FT232
+#define I2C_PIN_SDA 0x10 // DTR of FT232
+
 namespace ft232gpio
 {
 
+// bus waits in usecs, rounded up to samples of the bitbang clock
+struct I2CTiming
+{
+  uint32_t setup_usecs; // SDA before SCL rises
+  uint32_t clock_usecs; // SCL high, and waits around start and stop
+};
+
+static constexpr I2CTiming I2C_TIMING_DEFAULT = {10, 10};
+
 class I2C
 {
 public:
@@ -29,17 +42,34 @@ public:
   virtual ~I2C();
 
 public:
+  // FT232 pins for SCL and SDA, set before init()
+  void pins(uint8_t scl, uint8_t sda);
+  uint8_t pin_mask(void) const { return _pin_scl | _pin_sda; }
+
+  // timing comes from the profile of the adapter and address if there is one
   bool init(FT232 *ft232, uint8_t addr);
   void release(void);
 
+  void timing(const I2CTiming &timing) { _timing = timing; }
+  const I2CTiming &timing(void) const { return _timing; }
+
   void start_cond(void);
   void stop_cond(void);
   void write_bit(bool bit);
   bool read_bit(void);
   bool write_byte(bool send_start, bool send_stop, uint8_t data);
   uint8_t read_byte(bool nack, bool send_stop);
+  // start, address and stop, reading the acknowledge in synchronous
+  // bitbang with SDA released. returns true when the device acknowledged.
+  bool probe(void);
+  // reads length bytes in one read transaction, the acknowledge and data
+  // bits are read in synchronous bitbang like probe(). returns false when
+  // the device did not acknowledge or the transfer failed.
+  bool read(uint8_t *data, int32_t length);
 
   bool is_lost(void) { return _lost; }
+  FT232 *ft232(void) { return _ft232; }
+  uint8_t addr(void) const { return _addr; }
 
 private:
   void _set_sda(void);
@@ -49,18 +79,28 @@ private:
   uint8_t _read_scl(void);
   uint8_t _read_sda(void);
   void _delay(void);
+  void _delay_setup(void);
   void _arbitration_lost(void);
   void _wait_scl(void);
   void _dummy_clock(void);
+  bool _send_address(bool read);
+  bool _read_bits(int32_t count, uint32_t &bits);
+  void _replay(void);
+  void _write_pins(void);
 
 private:
   FT232 *_ft232 = nullptr;
   uint8_t _addr = 0x00;
+  uint8_t _pin_scl = I2C_PIN_SCL;
+  uint8_t _pin_sda = I2C_PIN_SDA;
   bool _initalized = false;
-  uint8_t _ft232_data = 0x00;
+  uint8_t _ft232_data = 0x00; // SCL and SDA, other bits are not used
+  I2CTiming _timing = I2C_TIMING_DEFAULT;
 
   bool _started = false;
   bool _lost = false;
+
+  FT232Replay _replay_entry;
 };
 
 } // namespace ft232gpio
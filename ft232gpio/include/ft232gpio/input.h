@@ -0,0 +1,101 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_INPUT_H__
+#define __FT232GPIO_INPUT_H__
+
+#include "ft232.h"
+#include "event.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+namespace ft232gpio
+{
+
+struct InputEvent
+{
+  uint8_t pin; // one bit
+  bool level;  // true for rising, false for falling
+  std::chrono::steady_clock::time_point time;
+};
+
+/**
+ * Watches input pins on a background thread. The adapter samples the pins
+ * continuously, the thread reads the samples in bulk so pulses between two
+ * reads are not missed. Each pin is debounced, a level is accepted when it
+ * holds for the debounce time. Events go to the callback or to the queue.
+ *
+ * Capture and synchronous transfers use the same sample stream, they do
+ * not run while watching.
+ */
+class InputWatcher
+{
+public:
+  InputWatcher() = default;
+  virtual ~InputWatcher();
+
+public:
+  // pins are inputs while watching. samples are taken at rate per second,
+  // up to the FT232 sample rate. the first samples are read before it
+  // returns, so state() has the levels of the pins.
+  bool start(FT232 *ft232, uint8_t pins, uint32_t rate = 10000, uint32_t debounce_usecs = 1000);
+  void stop(void);
+  // debounce of pins, 0 to report every change
+  void debounce(uint8_t pins, uint32_t usecs);
+
+public:
+  // callback runs on the watching thread, events are queued when not set
+  void on_edge(std::function<void(const InputEvent &)> callback);
+  bool poll(InputEvent &event) { return _queue.poll(event); }
+  bool wait(InputEvent &event, uint32_t timeout_ms) { return _queue.wait(event, timeout_ms); }
+
+  uint8_t state(void) const { return _state; } // debounced levels
+
+private:
+  void run(void);
+  void feed(const uint8_t *buf, int count);
+  void sample(uint8_t value, uint64_t index);
+  void emit(uint8_t pin, bool level, uint64_t index);
+
+private:
+  FT232 *_ft232 = nullptr;
+  uint8_t _pins = 0x00;
+  uint8_t _inputs = 0x00; // of FT232 before start
+  uint32_t _decimate = 1; // FT232 samples for one sample
+  uint32_t _rate = 0;     // samples per second after decimate
+
+  std::atomic<uint32_t> _debounce[8]; // usecs
+  uint32_t _count[8] = {0};            // samples candidate level has held
+  uint8_t _candidate = 0x00;
+  std::atomic<uint8_t> _state{0x00};
+  bool _has_state = false;
+  uint64_t _index = 0; // FT232 samples since start
+  std::chrono::steady_clock::time_point _start;
+
+  std::thread _thread;
+  std::atomic<bool> _running{false};
+
+  std::mutex _callback_mutex;
+  std::function<void(const InputEvent &)> _callback;
+  EventQueue<InputEvent> _queue;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_INPUT_H__
@@ -14,60 +14,44 @@
  * limitations under the License.
  */
 
+
 #ifndef __FT232GPIO_LCD1602_H__
 #define __FT232GPIO_LCD1602_H__
 
-#include "lcd1602_def.h"
+#include "hd44780.h"
 #include "i2c.h"
 
 namespace ft232gpio
 {
 
-class LCD1602
+// HD44780 with PCF8574 I2C backpack
+class LCD1602 : public HD44780
 {
 public:
   LCD1602() = default;
-  virtual ~LCD1602() = default;
+  explicit LCD1602(const LCDGeometry &geometry) : HD44780(geometry) {}
 
 public:
   bool init(I2C *i2c);
+  // attach to a panel that is already initialized, eg. on process restart.
+  // resyncs 4bit mode with short delays and restores display flags without
+  // clearing, so the current text stays. display shift is not known, call
+  // home() if the previous owner used marquee or double buffer.
+  bool attach(I2C *i2c, bool cursor = false, bool blink = false);
   void release(void);
 
-public:
-  bool initialized(void) { return _initalized; }
-
-public:
-  void clear();
-  void home();
-  void display(bool enable); // display on/off
-  void cursor(bool enable);  // cursor on/off
-  void blink(bool enable);   // blinking on/off
-  void puts(const char *str);
-  void putch(uint8_t ch);
-  void move(uint8_t row, uint8_t col);
-  void cgram(uint8_t ch, uint8_t *data, uint32_t leng);
+protected:
+  FT232 *ft232(void) override { return _i2c->ft232(); }
+  void write_4bits(uint8_t nibble, bool rs, uint32_t delay) override;
+  void write_run(const uint8_t *data, uint32_t count, bool rs) override;
 
 private:
-  void function_set(uint8_t data);
-  void cursor_set(uint8_t data);
-  void display_set(void);
-  void entrymode_set(uint8_t data);
-  void putc(const char c);
-
-private:
-  void init_4bit(void);
-  void send_4bits(uint8_t lcddata, uint32_t delay);
-  void send_data(uint8_t data);
-  void send_ctrl(uint8_t data);
+  bool rs_changed(bool rs);
+  void send_byte(bool send_start, bool send_stop, uint8_t lcddata);
 
 private:
   I2C *_i2c = nullptr;
-  bool _initalized = false;
-
-  bool _back_light = false;
-  bool _display = false;
-  bool _cursor = false;
-  bool _blink = false;
+  int32_t _port_rs = -1; // RS on the PCF8574 port, -1 for unknown
 };
 
 } // namespace ft232gpio
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_LCD1602_PARALLEL_H__
+#define __FT232GPIO_LCD1602_PARALLEL_H__
+
+#include "hd44780.h"
+
+// default pins
+#define LCD_PIN_D4 0x01 // TXD of FT232
+#define LCD_PIN_D5 0x02 // RXD of FT232
+#define LCD_PIN_D6 0x04 // RTS of FT232
+#define LCD_PIN_D7 0x08 // CTS of FT232
+#define LCD_PIN_RS 0x10 // DTR of FT232
+#define LCD_PIN_EN 0x20 // DSR of FT232
+
+namespace ft232gpio
+{
+
+/**
+ * HD44780 wired to FT232 pins in 4bit mode, without I2C backpack.
+ * RW is tied to ground. A nibble is three samples, data with EN low, EN high
+ * and EN low, so a character takes about a tenth of the time on PCF8574.
+ */
+class LCD1602Parallel : public HD44780
+{
+public:
+  LCD1602Parallel() = default;
+  explicit LCD1602Parallel(const LCDGeometry &geometry) : HD44780(geometry) {}
+
+public:
+  // FT232 pins, set before init(). bl 0 for backlight not on a pin
+  void pins(uint8_t rs, uint8_t en, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7,
+            uint8_t bl = 0);
+  uint8_t pin_mask(void) const;
+
+  bool init(FT232 *ft232);
+  // attach to a panel that is already initialized, same as LCD1602::attach()
+  bool attach(FT232 *ft232, bool cursor = false, bool blink = false);
+  void release(void);
+
+protected:
+  FT232 *ft232(void) override { return _ft232; }
+  void write_4bits(uint8_t nibble, bool rs, uint32_t delay) override;
+  void write_run(const uint8_t *data, uint32_t count, bool rs) override;
+  bool fast_commands(void) const override { return true; } // flip takes about 1ms
+
+private:
+  // samples of a nibble on top of the pins of other devices
+  void nibble_samples(uint8_t nibble, bool rs, uint8_t *samples) const;
+
+private:
+  FT232 *_ft232 = nullptr;
+  uint8_t _pin_rs = LCD_PIN_RS;
+  uint8_t _pin_en = LCD_PIN_EN;
+  uint8_t _pin_data[4] = {LCD_PIN_D4, LCD_PIN_D5, LCD_PIN_D6, LCD_PIN_D7};
+  uint8_t _pin_bl = 0;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_LCD1602_PARALLEL_H__
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_LCD_GEOMETRY_H__
+#define __FT232GPIO_LCD_GEOMETRY_H__
+
+#include <cstdint>
+
+namespace ft232gpio
+{
+
+// HD44780 DDRAM has two lines of 40 characters, at 0x00 and 0x40
+static constexpr uint8_t LCD_DDRAM_LINE_COLS = 40;
+static constexpr uint8_t LCD_DDRAM_LINE1 = 0x40;
+static constexpr uint8_t LCD_ROWS_MAX = 4;
+
+/**
+ * Visible window of a HD44780 panel over DDRAM.
+ *
+ * Panels with 4 rows continue row 0 into row 2 and row 1 into row 3 on the
+ * same DDRAM line, so row 2 starts at 0x00 + cols and row 3 at 0x40 + cols.
+ * Rows past the panel repeat the last row in the tables, rows past the
+ * tables are clamped to the last entry.
+ */
+struct LCDGeometry
+{
+  uint8_t cols;
+  uint8_t rows;
+  uint8_t row_offset[LCD_ROWS_MAX]; // DDRAM address of column 0
+  uint8_t col_max[LCD_ROWS_MAX];    // last column that stays in the DDRAM line
+
+  constexpr uint16_t cells(void) const { return uint16_t(cols) * rows; }
+
+  constexpr uint8_t addr(uint8_t row, uint8_t col) const
+  {
+    const uint8_t r = row < LCD_ROWS_MAX ? row : LCD_ROWS_MAX - 1;
+    return row_offset[r] + (col < col_max[r] ? col : col_max[r]);
+  }
+};
+
+constexpr uint8_t lcd_row_offset(uint8_t cols, uint8_t row)
+{
+  return (row & 0x01 ? LCD_DDRAM_LINE1 : 0x00) + (row & 0x02 ? cols : 0);
+}
+
+constexpr LCDGeometry make_lcd_geometry(uint8_t cols, uint8_t rows)
+{
+  LCDGeometry geo{cols, rows, {0, 0, 0, 0}, {0, 0, 0, 0}};
+  for (uint8_t r = 0; r < LCD_ROWS_MAX; ++r)
+  {
+    uint8_t row = r < rows ? r : rows - 1;
+    geo.row_offset[r] = lcd_row_offset(cols, row);
+    geo.col_max[r] = LCD_DDRAM_LINE_COLS - 1 - (geo.row_offset[r] & 0x3f);
+  }
+  return geo;
+}
+
+static constexpr LCDGeometry LCD_GEOMETRY_16x2 = make_lcd_geometry(16, 2);
+static constexpr LCDGeometry LCD_GEOMETRY_16x4 = make_lcd_geometry(16, 4);
+static constexpr LCDGeometry LCD_GEOMETRY_20x4 = make_lcd_geometry(20, 4);
+static constexpr LCDGeometry LCD_GEOMETRY_40x2 = make_lcd_geometry(40, 2);
+
+static_assert(LCD_GEOMETRY_16x2.addr(1, 0) == 0x40, "16x2 row 1");
+static_assert(LCD_GEOMETRY_16x2.addr(3, 5) == 0x45, "16x2 clamps row");
+static_assert(LCD_GEOMETRY_16x2.addr(4, 0) == 0x40, "16x2 clamps row past tables");
+static_assert(LCD_GEOMETRY_20x4.addr(4, 0) == 0x54, "20x4 clamps row past tables");
+static_assert(LCD_GEOMETRY_20x4.addr(2, 0) == 0x14, "20x4 row 2");
+static_assert(LCD_GEOMETRY_20x4.addr(3, 0) == 0x54, "20x4 row 3");
+static_assert(LCD_GEOMETRY_20x4.addr(2, 30) == 0x27, "20x4 clamps column");
+static_assert(LCD_GEOMETRY_16x4.addr(3, 0) == 0x50, "16x4 row 3");
+static_assert(LCD_GEOMETRY_40x2.addr(1, 39) == 0x67, "40x2 last cell");
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_LCD_GEOMETRY_H__
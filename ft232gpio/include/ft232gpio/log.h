@@ -0,0 +1,74 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_LOG_H__
+#define __FT232GPIO_LOG_H__
+
+#include <atomic>
+#include <cstdint>
+
+// clang-format off
+#define FT232GPIO_LOG_TRACE 0
+#define FT232GPIO_LOG_DEBUG 1
+#define FT232GPIO_LOG_INFO  2
+#define FT232GPIO_LOG_WARN  3
+#define FT232GPIO_LOG_ERROR 4
+#define FT232GPIO_LOG_OFF   5
+// clang-format on
+
+// levels below this are not compiled at all
+#ifndef FT232GPIO_LOG_LEVEL
+#define FT232GPIO_LOG_LEVEL FT232GPIO_LOG_DEBUG
+#endif
+
+namespace ft232gpio
+{
+
+// levels below this are compiled but skipped at runtime
+inline std::atomic<int> _log_level{FT232GPIO_LOG_INFO};
+
+inline void log_level(int level) { _log_level.store(level, std::memory_order_relaxed); }
+inline int log_level(void) { return _log_level.load(std::memory_order_relaxed); }
+
+/**
+ * Formats the message into a lock-free ring buffer and returns, a background
+ * thread writes the ring to stderr. Messages are dropped when the ring is
+ * full, the count of dropped messages is written with the next one.
+ */
+void log_write(int level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// writes out everything queued so far, from the calling thread
+void log_flush(void);
+
+} // namespace ft232gpio
+
+#define FT232GPIO_LOG(level, ...)                                          \
+  do                                                                       \
+  {                                                                        \
+    if constexpr (level >= FT232GPIO_LOG_LEVEL)                            \
+    {                                                                      \
+      if (level >= ::ft232gpio::log_level())                               \
+        ::ft232gpio::log_write(level, __VA_ARGS__);                        \
+    }                                                                      \
+  } while (0)
+
+#define FT232GPIO_TRACE(...) FT232GPIO_LOG(FT232GPIO_LOG_TRACE, __VA_ARGS__)
+#define FT232GPIO_DEBUG(...) FT232GPIO_LOG(FT232GPIO_LOG_DEBUG, __VA_ARGS__)
+#define FT232GPIO_INFO(...) FT232GPIO_LOG(FT232GPIO_LOG_INFO, __VA_ARGS__)
+#define FT232GPIO_WARN(...) FT232GPIO_LOG(FT232GPIO_LOG_WARN, __VA_ARGS__)
+#define FT232GPIO_ERROR(...) FT232GPIO_LOG(FT232GPIO_LOG_ERROR, __VA_ARGS__)
+
+#endif // __FT232GPIO_LOG_H__
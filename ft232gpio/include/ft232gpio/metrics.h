@@ -0,0 +1,92 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_METRICS_H__
+#define __FT232GPIO_METRICS_H__
+
+#include <cstdint>
+
+#define METRICS_CPUS_MAX 64
+#define METRICS_PATH_MAX 128
+#define METRICS_READ_SIZE 8192 // /proc/stat cpu lines come first
+
+namespace ft232gpio
+{
+
+struct MemInfo
+{
+  uint64_t total_kb = 0;
+  uint64_t free_kb = 0;
+  uint64_t available_kb = 0;
+};
+
+struct LoadAvg
+{
+  float one = 0;
+  float five = 0;
+  float fifteen = 0;
+};
+
+/**
+ * System metrics for status panels. init() finds the CPU temperature
+ * sensor once and opens the files, each read is a pread() of the open file
+ * into a fixed buffer and parsing without allocation.
+ */
+class Metrics
+{
+public:
+  Metrics() = default;
+  virtual ~Metrics();
+
+  Metrics(const Metrics &) = delete;
+  Metrics &operator=(const Metrics &) = delete;
+
+public:
+  // false when none of the files could be opened
+  bool init(void);
+  void release(void);
+
+public:
+  // CPU temperature in millidegree Celsius
+  bool temperature(int32_t &millic);
+  // sysfs file the temperature is read from, empty when none was found
+  const char *temperature_path(void) const { return _temp_path; }
+  bool meminfo(MemInfo &info);
+  bool loadavg(LoadAvg &load);
+  // busy percent of each core since the last call, since boot on the first.
+  // returns the number of cores written, -1 on error
+  int32_t cpu_usage(uint8_t *percent, int32_t count);
+
+private:
+  bool find_temperature(void);
+  int32_t read(int fd, char *buf, int32_t size);
+
+private:
+  int _fd_temp = -1;
+  int _fd_meminfo = -1;
+  int _fd_loadavg = -1;
+  int _fd_stat = -1;
+  char _temp_path[METRICS_PATH_MAX] = {0};
+
+  char _buf[METRICS_READ_SIZE];
+  uint64_t _cpu_busy[METRICS_CPUS_MAX] = {0};
+  uint64_t _cpu_total[METRICS_CPUS_MAX] = {0};
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_METRICS_H__
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_ONEWIRE_H__
+#define __FT232GPIO_ONEWIRE_H__
+
+#include "ft232.h"
+
+#include <vector>
+
+// default pins, TX drives the bus through a diode so it only pulls low
+// and RX reads the bus
+#define ONEWIRE_PIN_TX 0x01 // TXD of FT232
+#define ONEWIRE_PIN_RX 0x02 // RXD of FT232
+
+// ROM commands
+#define ONEWIRE_SEARCH_ROM 0xF0
+#define ONEWIRE_READ_ROM 0x33
+#define ONEWIRE_MATCH_ROM 0x55
+#define ONEWIRE_SKIP_ROM 0xCC
+
+namespace ft232gpio
+{
+
+/**
+ * 1-Wire master. Slots are encoded as samples of the bitbang clock, so
+ * their timing does not depend on the host. reset(), write() and read()
+ * queue slots, commit() sends them all. Slots that need the bus read back
+ * make commit() use one FT232::transfer(), write only slots go into the
+ * current batch.
+ */
+class OneWire
+{
+public:
+  OneWire() = default;
+  virtual ~OneWire() = default;
+
+public:
+  // FT232 pins, set before init()
+  void pins(uint8_t tx, uint8_t rx);
+  uint8_t pin_mask(void) const { return _pin_tx | _pin_rx; }
+
+  bool init(FT232 *ft232);
+  void release(void);
+
+public:
+  void reset(void);
+  void write(const uint8_t *data, int32_t length);
+  void write_byte(uint8_t data) { write(&data, 1); }
+  void read(int32_t length);
+  // in gets bytes of read() in order. false when sending failed or a reset
+  // had no presence pulse
+  bool commit(uint8_t *in = nullptr);
+
+public:
+  // finds ROM codes of all devices on the bus, family 0 for any
+  bool search(std::vector<uint64_t> &roms, uint8_t family = 0);
+  static uint8_t crc8(const uint8_t *data, int32_t length);
+
+public:
+  bool initialized(void) { return _initalized; }
+  FT232 *ft232(void) { return _ft232; }
+
+private:
+  uint32_t slot(uint32_t low, uint32_t wait, uint32_t rest); // returns sample index
+  void write_bit(bool bit);
+  void read_bit(void);
+
+private:
+  FT232 *_ft232 = nullptr;
+  uint8_t _pin_tx = ONEWIRE_PIN_TX;
+  uint8_t _pin_rx = ONEWIRE_PIN_RX;
+  bool _initalized = false;
+
+  // queued slots
+  std::vector<uint8_t> _out;      // TX level only, other pins are added by commit()
+  std::vector<uint32_t> _breaks; // where transfer may pause
+  std::vector<uint32_t> _reads;    // samples for read slots
+  std::vector<uint32_t> _presence; // samples for presence after reset
+  std::vector<uint8_t> _in;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_ONEWIRE_H__
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_PROFILE_H__
+#define __FT232GPIO_PROFILE_H__
+
+#include "hd44780.h"
+#include "i2c.h"
+#include "tm1637.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// path of the profiles, else $HOME/.config/ft232gpio/timing
+#define TIMING_PROFILE_ENV "FT232GPIO_TIMING"
+
+namespace ft232gpio
+{
+
+/**
+ * Bus timing of devices per adapter, as found by TimingTuner. Saved as
+ * text with one device per line,
+ *   <adapter serial> <i2c|tm1637|lcd> <addr> <usecs> ...
+ * where addr is the I2C address or the pin mask of a device on FT232 pins
+ * and usecs are the fields of the timing struct in order.
+ */
+class TimingProfiles
+{
+public:
+  bool load(const std::string &path);
+  bool save(const std::string &path) const;
+  static std::string default_path(void);
+
+public:
+  // timing is left as it is when there is no profile
+  bool lookup(const std::string &serial, uint32_t addr, I2CTiming &timing) const;
+  bool lookup(const std::string &serial, uint32_t addr, TM1637Timing &timing) const;
+  bool lookup(const std::string &serial, uint32_t addr, LCDTiming &timing) const;
+  void store(const std::string &serial, uint32_t addr, const I2CTiming &timing);
+  void store(const std::string &serial, uint32_t addr, const TM1637Timing &timing);
+  void store(const std::string &serial, uint32_t addr, const LCDTiming &timing);
+
+private:
+  using Key = std::tuple<std::string, std::string, uint32_t>;
+
+  bool get(const Key &key, uint32_t *values, size_t count) const;
+  void set(const Key &key, const uint32_t *values, size_t count);
+  static Key key(const std::string &serial, const char *kind, uint32_t addr);
+
+private:
+  mutable std::mutex _mutex;
+  std::map<Key, std::vector<uint32_t>> _profiles;
+};
+
+// profiles of default_path(), loaded on first use. drivers look up their
+// timing here in init()
+TimingProfiles &timing_profiles(void);
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_PROFILE_H__
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_PWM_H__
+#define __FT232GPIO_PWM_H__
+
+#include "ft232.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define PWM_CHANNELS 8 // one for each pin
+#define PWM_BUFFERS 3  // two in flight, one to prepare
+
+namespace ft232gpio
+{
+
+/**
+ * PWM on bitbang pins timed by the sample clock. One period of all channels
+ * is made into a buffer of samples which a thread streams again and again
+ * with asynchronous writes. The buffer is made again only when a duty or the
+ * other pins change, new duty takes effect at a period boundary.
+ *
+ * Other drivers can use the FT232 meanwhile, PWM pins hold their level
+ * while their samples are sent.
+ */
+class PWM
+{
+public:
+  PWM() = default;
+  virtual ~PWM();
+
+public:
+  // pins to drive, all start low
+  bool start(FT232 *ft232, uint8_t pins, uint32_t period_usecs);
+  void stop(void);
+
+  // pin is one bit of pins. duty 0 ~ 1000 of the period
+  void duty(uint8_t pin, uint32_t permille);
+  // high time, eg. 1000 ~ 2000 usecs for servos with 20000 usecs period
+  void pulse(uint8_t pin, uint32_t usecs);
+
+public:
+  bool running(void) const { return _running; }
+  uint32_t period_samples(void) const { return _period; }
+
+private:
+  void run(void);
+  void build(std::vector<uint8_t> &buffer, uint8_t base);
+  void high(uint8_t pin, uint32_t samples);
+
+private:
+  FT232 *_ft232 = nullptr;
+  uint8_t _pins = 0x00;
+  uint32_t _period = 0;  // samples
+  uint32_t _repeat = 0;  // periods in one buffer
+
+  std::mutex _duty_mutex;
+  uint32_t _high[PWM_CHANNELS] = {0}; // samples, guarded by _duty_mutex
+  uint32_t _generation = 0;           // changes with _high
+
+  struct Buffer
+  {
+    std::vector<uint8_t> samples;
+    uint32_t generation;
+    uint8_t base; // other pins
+  };
+  Buffer _buffers[PWM_BUFFERS];
+
+  std::thread _thread;
+  std::atomic<bool> _running{false};
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_PWM_H__
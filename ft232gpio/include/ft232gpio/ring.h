@@ -0,0 +1,125 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_RING_H__
+#define __FT232GPIO_RING_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ft232gpio
+{
+
+/**
+ * Bounded lock-free queue, any number of producers and consumers.
+ * Each cell has a sequence number that tells whether it is free to write or
+ * ready to read for the current lap (D. Vyukov bounded MPMC queue).
+ * push and pop never block, they fail when the queue is full or empty.
+ */
+template <typename T, size_t SIZE> class RingQueue
+{
+  static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SIZE must be power of 2");
+
+public:
+  RingQueue()
+  {
+    for (size_t i = 0; i < SIZE; ++i)
+      _cells[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  RingQueue(const RingQueue &) = delete;
+  RingQueue &operator=(const RingQueue &) = delete;
+
+public:
+  // fill(T &) writes the item in place
+  template <typename FILL> bool push_with(FILL fill)
+  {
+    size_t pos = _enqueue.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true)
+    {
+      cell = &_cells[pos & (SIZE - 1)];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = intptr_t(seq) - intptr_t(pos);
+      if (diff == 0)
+      {
+        if (_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return false; // full
+      else
+        pos = _enqueue.load(std::memory_order_relaxed);
+    }
+    fill(cell->data);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // take(T &) reads the item in place
+  template <typename TAKE> bool pop_with(TAKE take)
+  {
+    size_t pos = _dequeue.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true)
+    {
+      cell = &_cells[pos & (SIZE - 1)];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+      if (diff == 0)
+      {
+        if (_dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return false; // empty
+      else
+        pos = _dequeue.load(std::memory_order_relaxed);
+    }
+    take(cell->data);
+    cell->seq.store(pos + SIZE, std::memory_order_release);
+    return true;
+  }
+
+  bool push(const T &item)
+  {
+    return push_with([&item](T &data) { data = item; });
+  }
+
+  bool pop(T &item)
+  {
+    return pop_with([&item](T &data) { item = data; });
+  }
+
+  static constexpr size_t capacity(void) { return SIZE; }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> seq;
+    T data;
+  };
+
+  // producers and consumers touch different cache lines
+  alignas(64) Cell _cells[SIZE];
+  alignas(64) std::atomic<size_t> _enqueue{0};
+  alignas(64) std::atomic<size_t> _dequeue{0};
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_RING_H__
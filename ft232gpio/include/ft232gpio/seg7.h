@@ -0,0 +1,136 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_SEG7_H__
+#define __FT232GPIO_SEG7_H__
+
+#include <array>
+#include <cstdint>
+
+//  --a--
+// |     |
+// f     b
+// |     |
+//  --g--
+// |     |
+// e     c
+// |     |
+//  --d--  dp
+//
+// clang-format off
+#define SEG7_A      0b00000001
+#define SEG7_B      0b00000010
+#define SEG7_C      0b00000100
+#define SEG7_D      0b00001000
+#define SEG7_E      0b00010000
+#define SEG7_F      0b00100000
+#define SEG7_G      0b01000000
+#define SEG7_DP     0b10000000 // decimal point, or colon on digit 1 of clock modules
+
+#define SEG7_BLANK  0b00000000
+#define SEG7_MINUS  SEG7_G
+#define SEG7_DEGREE (SEG7_A | SEG7_B | SEG7_F | SEG7_G)
+// clang-format on
+
+namespace ft232gpio
+{
+
+using Seg7Font = std::array<uint8_t, 128>;
+
+constexpr Seg7Font make_seg7_font(void)
+{
+  Seg7Font f{};
+
+  const uint8_t digits[16] = {
+    0b00111111, 0b00000110, 0b01011011, 0b01001111, // 0 1 2 3
+    0b01100110, 0b01101101, 0b01111101, 0b00000111, // 4 5 6 7
+    0b01111111, 0b01101111, 0b01110111, 0b01111100, // 8 9 A b
+    0b00111001, 0b01011110, 0b01111001, 0b01110001, // C d E F
+  };
+  for (int i = 0; i < 10; ++i)
+    f['0' + i] = digits[i];
+
+  // letters, upper and lower case share one shape unless both can be shown
+  const uint8_t letters[26] = {
+    0b01110111, 0b01111100, 0b00111001, 0b01011110, 0b01111001, // A b C d E
+    0b01110001, 0b00111101, 0b01110110, 0b00000110, 0b00011110, // F G H I J
+    0b01110110, 0b00111000, 0b00010101, 0b01010100, 0b00111111, // K L M n O
+    0b01110011, 0b01100111, 0b01010000, 0b01101101, 0b01111000, // P q r S t
+    0b00111110, 0b00111110, 0b00101010, 0b01110110, 0b01101110, // U V W X y
+    0b01011011,                                                 // Z
+  };
+  for (int i = 0; i < 26; ++i)
+  {
+    f['A' + i] = letters[i];
+    f['a' + i] = letters[i];
+  }
+  f['c'] = 0b01011000;
+  f['h'] = 0b01110100;
+  f['i'] = 0b00000100;
+  f['o'] = 0b01011100;
+  f['u'] = 0b00011100;
+
+  f[' '] = SEG7_BLANK;
+  f['-'] = SEG7_MINUS;
+  f['_'] = SEG7_D;
+  f['='] = SEG7_D | SEG7_G;
+  f['\''] = SEG7_F;
+  f['"'] = SEG7_B | SEG7_F;
+  f['['] = SEG7_A | SEG7_D | SEG7_E | SEG7_F;
+  f[']'] = SEG7_A | SEG7_B | SEG7_C | SEG7_D;
+  f['^'] = SEG7_DEGREE; // no degree sign in ASCII
+  f['*'] = SEG7_DEGREE;
+  return f;
+}
+
+static constexpr Seg7Font SEG7_FONT = make_seg7_font();
+
+// hex digit 0 ~ 15 to segments
+static constexpr uint8_t SEG7_HEX[16] = {
+  SEG7_FONT['0'], SEG7_FONT['1'], SEG7_FONT['2'], SEG7_FONT['3'],
+  SEG7_FONT['4'], SEG7_FONT['5'], SEG7_FONT['6'], SEG7_FONT['7'],
+  SEG7_FONT['8'], SEG7_FONT['9'], SEG7_FONT['A'], SEG7_FONT['b'],
+  SEG7_FONT['C'], SEG7_FONT['d'], SEG7_FONT['E'], SEG7_FONT['F'],
+};
+
+constexpr uint8_t seg7_char(char c) { return SEG7_FONT[uint8_t(c) & 0x7f]; }
+
+static_assert(seg7_char('8') == 0x7f, "all segments but dp");
+static_assert(SEG7_HEX[0xb] == 0b01111100, "lower b");
+
+/**
+ * Formatters fill `count` digits of `out` from the left, without allocation.
+ * Numbers are right aligned. When the value does not fit all digits show
+ * minus and false is returned.
+ */
+
+// text, '.' sets the dp bit of the previous digit
+bool seg7_text(uint8_t *out, int32_t count, const char *text);
+// integer, zero_pad fills leading digits with 0 instead of blank
+bool seg7_int(uint8_t *out, int32_t count, int32_t value, bool zero_pad = false);
+// hex, always zero padded
+bool seg7_hex(uint8_t *out, int32_t count, uint32_t value);
+// fixed point, value 1234 with decimals 2 shows 12.34
+bool seg7_fixed(uint8_t *out, int32_t count, int32_t value, int32_t decimals);
+// HH:MM on 4 digits, colon is dp bit of digit 1, toggle colon to blink
+bool seg7_time(uint8_t *out, int32_t hour, int32_t minute, bool colon);
+// temperature in tenths with degree sign on the last digit, 234 shows 23.4*
+// drops the decimal when it does not fit
+bool seg7_temp(uint8_t *out, int32_t count, int32_t tenths);
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_SEG7_H__
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_SIM_BUS_H__
+#define __FT232GPIO_SIM_BUS_H__
+
+#include "sim_device.h"
+
+namespace ft232gpio
+{
+
+// minimum times of a clock and data bus, in ns
+struct SimBusTiming
+{
+  uint32_t low_ns;        // clock low
+  uint32_t high_ns;       // clock high
+  uint32_t setup_ns;      // data stable before clock rises
+  uint32_t hold_ns;       // data stable after clock rises
+  uint32_t start_hold_ns; // clock high after start
+  uint32_t stop_setup_ns; // clock high before stop
+};
+
+// I2C standard mode, 100kHz
+static constexpr SimBusTiming SIM_TIMING_I2C = {4700, 4000, 250, 0, 4000, 4000};
+// TM1637 datasheet
+static constexpr SimBusTiming SIM_TIMING_TM1637 = {400, 400, 100, 100, 400, 400};
+
+/**
+ * Receiver of a two wire bus, I2C or TM1637. Data changes while the clock
+ * is high are start (falling) and stop (rising), bits are taken at the
+ * rising clock and 8 bits and an acknowledge clock make a byte. When clock
+ * and data change in one sample, data is taken to change after a falling
+ * clock and before a rising one, the worse case for setup.
+ * A device sends a byte by pulling data low from the falling clocks, the
+ * host acknowledges each one and a nack ends the sending.
+ * A timing violation loses the transaction, the device neither
+ * acknowledges nor takes bytes until the next start.
+ */
+class SimTwoWire : public SimDevice
+{
+public:
+  SimTwoWire(uint8_t pin_clock, uint8_t pin_data, const SimBusTiming &timing, bool lsb_first);
+
+public:
+  uint8_t pulls(void) const override { return _acking || _tx_low ? _pin_data : 0; }
+
+protected:
+  void sample(uint8_t pins) override;
+  void on_violation(void) override;
+
+  virtual void on_start(void) {}
+  // after the 8th bit, true to pull data low for the acknowledge clock
+  virtual bool ack(uint8_t byte) { return false; }
+  virtual void on_byte(uint8_t byte) {} // after the acknowledge clock
+  // after a byte the device acknowledged, or the acknowledge of a byte it
+  // sent, true to send byte to the host
+  virtual bool transmit(uint8_t &byte) { return false; }
+  virtual void on_stop(void) {}
+
+private:
+  void clock_fall(void);
+  void data_change(bool data);
+  void clock_rise(void);
+
+private:
+  uint8_t _pin_clock;
+  uint8_t _pin_data;
+  SimBusTiming _timing;
+  bool _lsb_first;
+
+  bool _first = true;
+  bool _clock = true;
+  bool _data = true;
+  uint64_t _clock_at = 0; // last clock edge
+  uint64_t _rise_at = 0;  // last rising clock
+  uint64_t _data_at = 0;  // last data change
+  uint64_t _start_at = 0;
+  bool _started = false;
+  bool _start_hold = false; // first falling clock after start is not checked yet
+  uint32_t _bits = 0;
+  uint8_t _byte = 0;
+  bool _lost = false; // violation in this transaction
+  bool _ack = false;  // acknowledge of the byte, driven from the next falling clock
+  bool _acking = false;
+  bool _sending = false; // bits are sent to the host
+  uint8_t _tx = 0;
+  bool _tx_low = false; // pulling data low for a 0 bit of _tx
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_SIM_BUS_H__
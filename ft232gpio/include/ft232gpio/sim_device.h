@@ -0,0 +1,68 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_SIM_DEVICE_H__
+#define __FT232GPIO_SIM_DEVICE_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define SIM_VIOLATIONS_MAX 64 // kept, others are only counted
+
+namespace ft232gpio
+{
+
+/**
+ * Model of a device on the adapter pins, for FT232Sim::attach().
+ * It sees every sample written with its time from the sample rate and
+ * reports timing violations as text.
+ */
+class SimDevice
+{
+public:
+  SimDevice() = default;
+  virtual ~SimDevice() = default;
+
+public:
+  void feed(const uint8_t *buf, int size, uint32_t sample_rate);
+
+  uint32_t violation_count(void) const { return _violation_count; }
+  const std::vector<std::string> &violations(void) const { return _violations; }
+  void clear_violations(void);
+
+  // pins the device pulls low on the sample fed last, eg. an acknowledge
+  virtual uint8_t pulls(void) const { return 0; }
+
+protected:
+  // pins of one sample, which starts at nsecs()
+  virtual void sample(uint8_t pins) = 0;
+  uint64_t nsecs(void) const { return _nsecs; }
+  // for models driven by another model instead of samples
+  void nsecs(uint64_t now) { _nsecs = now; }
+  void violation(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+  virtual void on_violation(void) {}
+
+private:
+  uint64_t _nsecs = 0;
+  uint32_t _violation_count = 0;
+  std::vector<std::string> _violations;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_SIM_DEVICE_H__
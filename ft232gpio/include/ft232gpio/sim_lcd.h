@@ -0,0 +1,168 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_SIM_LCD_H__
+#define __FT232GPIO_SIM_LCD_H__
+
+#include "sim_bus.h"
+#include "lcd1602_def.h"
+#include "lcd1602_parallel.h"
+#include "lcd_geometry.h"
+#include "i2c.h"
+
+#include <functional>
+#include <string>
+
+namespace ft232gpio
+{
+
+/**
+ * PCF8574 on I2C, the port follows each data byte written to the address.
+ * Reads are not modelled.
+ */
+class PCF8574Model : public SimTwoWire
+{
+public:
+  explicit PCF8574Model(uint8_t addr, uint8_t scl = I2C_PIN_SCL, uint8_t sda = I2C_PIN_SDA,
+                        const SimBusTiming &timing = SIM_TIMING_I2C);
+
+public:
+  uint8_t port(void) const { return _port; }
+  // levels that other devices drive on the port, read where port is high
+  void inputs(uint8_t levels) { _inputs = levels; }
+  // called with the port and the time it changes
+  void on_port(std::function<void(uint8_t port, uint64_t nsecs)> listener);
+
+protected:
+  void on_start(void) override;
+  bool ack(uint8_t byte) override;
+  void on_byte(uint8_t byte) override;
+  bool transmit(uint8_t &byte) override;
+
+private:
+  uint8_t _addr;
+  uint8_t _port = 0xFF;
+  uint8_t _inputs = 0xFF;
+  bool _reading = false;
+  uint32_t _index = 0; // byte in the transaction, 0 for the address
+  bool _selected = false;
+  std::function<void(uint8_t, uint64_t)> _listener;
+};
+
+// pins of HD44780 on the input, FT232 pins or PCF8574 port bits
+struct HD44780Pins
+{
+  uint8_t rs;
+  uint8_t en;
+  uint8_t bl; // 0 when backlight is not on a pin
+  uint8_t data[4]; // D4 ~ D7
+};
+
+static constexpr HD44780Pins HD44780_PINS_PCF8574 = {
+  PCF8574_LCD1604_RS, PCF8574_LCD1604_EN, PCF8574_LCD1604_BL, {0x10, 0x20, 0x40, 0x80}};
+static constexpr HD44780Pins HD44780_PINS_PARALLEL = {
+  LCD_PIN_RS, LCD_PIN_EN, 0, {LCD_PIN_D4, LCD_PIN_D5, LCD_PIN_D6, LCD_PIN_D7}};
+
+// minimum times of HD44780U at 5V, in ns
+struct HD44780Timing
+{
+  uint32_t rs_setup_ns; // RS before EN rises
+  uint32_t en_high_ns;  // EN pulse width
+  uint32_t setup_ns;    // data before EN falls
+  uint32_t hold_ns;     // RS and data after EN falls
+  uint32_t cycle_ns;    // EN cycle
+  uint32_t exec_ns;     // instruction and data write
+  uint32_t home_ns;     // clear display and return home
+};
+
+static constexpr HD44780Timing SIM_TIMING_HD44780 = {40, 230, 80, 10, 500, 37000, 1520000};
+
+/**
+ * HD44780 controller, from power on reset in 8bit mode. It takes
+ * instructions and data at falling EN, follows 4bit mode switch, and keeps
+ * DDRAM, CGRAM, address counter, display shift and flags. Writes while an
+ * instruction is still running are violations, they are still executed so
+ * one early write does not hide what follows. text() is what the panel
+ * shows.
+ */
+class HD44780Model : public SimDevice
+{
+public:
+  explicit HD44780Model(const HD44780Pins &pins = HD44780_PINS_PARALLEL,
+                        const LCDGeometry &geometry = LCD_GEOMETRY_16x2,
+                        const HD44780Timing &timing = SIM_TIMING_HD44780);
+
+public:
+  // inputs changed at nsecs, for a PCF8574Model port
+  void input(uint8_t value, uint64_t nsecs);
+
+public:
+  std::string text(uint8_t row) const;
+  uint8_t ddram(uint8_t addr) const;
+  const uint8_t *cgram(void) const { return _cgram; }
+  uint8_t address(void) const { return _ac; }
+  uint8_t shift(void) const { return _shift; }
+  bool four_bit(void) const { return _four_bit; }
+  bool display_on(void) const { return _display; }
+  bool cursor_on(void) const { return _cursor; }
+  bool blink_on(void) const { return _blink; }
+  bool backlight(void) const { return _backlight; }
+
+protected:
+  void sample(uint8_t pins) override;
+
+private:
+  void enable_fall(uint8_t value, uint64_t now);
+  void execute(bool rs, uint8_t byte, uint64_t now);
+  void instruction(uint8_t cmd, uint64_t now);
+  void write(uint8_t data);
+  void advance(void);
+
+private:
+  HD44780Pins _pins;
+  LCDGeometry _geometry;
+  HD44780Timing _timing;
+
+  bool _first = true;
+  uint8_t _value = 0;
+  uint64_t _rs_at = 0;   // last RS change
+  uint64_t _data_at = 0; // last data change
+  uint64_t _en_at = 0;   // last EN edge
+  uint64_t _fall_at = 0; // last falling EN
+  uint64_t _busy_until = 0;
+  uint32_t _resets = 0; // 8bit function sets, first ones take longer
+
+  bool _four_bit = false;
+  bool _low_nibble = false;
+  uint8_t _high = 0;
+
+  uint8_t _ddram[2][LCD_DDRAM_LINE_COLS];
+  uint8_t _cgram[64] = {0};
+  uint8_t _ac = 0;
+  bool _ac_cgram = false;
+  uint8_t _shift = 0;
+  bool _increment = true;
+  bool _entry_shift = false;
+  bool _display = false;
+  bool _cursor = false;
+  bool _blink = false;
+  bool _backlight = false;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_SIM_LCD_H__
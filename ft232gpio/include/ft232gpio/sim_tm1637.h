@@ -0,0 +1,64 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_SIM_TM1637_H__
+#define __FT232GPIO_SIM_TM1637_H__
+
+#include "sim_bus.h"
+#include "tm1637_def.h"
+
+namespace ft232gpio
+{
+
+/**
+ * TM1637 on its two wire bus, LSB first. Keeps the segment registers, data
+ * mode and display control. Key scan reads are not modelled, bytes after a
+ * read command are skipped.
+ */
+class TM1637Model : public SimTwoWire
+{
+public:
+  explicit TM1637Model(uint8_t clock = TM1637_PIN_CLOCK, uint8_t dio = TM1637_PIN_DIO,
+                       const SimBusTiming &timing = SIM_TIMING_TM1637);
+
+public:
+  const uint8_t *segments(void) const { return _segments; }
+  bool display_on(void) const { return _display; }
+  // 0 for off, 1 ~ 8 for the pulse widths, as TM1637::bright()
+  uint8_t bright(void) const { return _display ? _pulse + 1 : 0; }
+  uint32_t commands(void) const { return _commands; }
+
+protected:
+  void on_start(void) override;
+  bool ack(uint8_t byte) override { return true; }
+  void on_byte(uint8_t byte) override;
+
+private:
+  uint8_t _segments[TM1637_DIGITS_MAX] = {0};
+  bool _display = false;
+  uint8_t _pulse = 0;
+  bool _fixed = false;   // fixed address, else auto increment
+  bool _reading = false; // key scan
+  uint8_t _addr = 0;
+  uint32_t _index = 0; // byte in the transaction
+  uint8_t _command = 0;
+  uint32_t _commands = 0;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_SIM_TM1637_H__
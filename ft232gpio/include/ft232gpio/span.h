@@ -0,0 +1,97 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_SPAN_H__
+#define __FT232GPIO_SPAN_H__
+
+#include <atomic>
+#include <cstdint>
+
+// 1 to compile spans of driver operations, 0 leaves no code behind
+#ifndef FT232GPIO_SPANS
+#define FT232GPIO_SPANS 0
+#endif
+
+#define SPAN_THREAD_CAPACITY (1 << 16) // spans kept per thread, 1.5MB
+
+namespace ft232gpio
+{
+
+struct SpanThread;
+
+// spans are recorded only while enabled, off by default
+inline std::atomic<bool> _span_enabled{false};
+
+inline void span_enable(bool enable) { _span_enabled.store(enable, std::memory_order_relaxed); }
+inline bool span_enabled(void) { return _span_enabled.load(std::memory_order_relaxed); }
+
+/**
+ * Time of a scope on the calling thread, from construction to destruction,
+ * with the monotonic clock. Each thread appends finished spans to its own
+ * buffer, so nested spans of drivers need no lock between threads. Spans
+ * after the buffer is full are counted as dropped.
+ */
+class Span
+{
+public:
+  explicit Span(const char *name)
+  {
+    if (span_enabled())
+      begin(name);
+  }
+  ~Span()
+  {
+    if (_thread)
+      end();
+  }
+
+  Span(const Span &) = delete;
+  Span &operator=(const Span &) = delete;
+
+private:
+  void begin(const char *name);
+  void end(void);
+
+private:
+  SpanThread *_thread = nullptr;
+  const char *_name = nullptr;
+  int64_t _begin = 0;
+};
+
+// names the calling thread in the export
+void span_thread_name(const char *name);
+// drops spans of all threads, while no span is open
+void span_clear(void);
+uint64_t span_dropped(void);
+// Chrome trace event JSON, for chrome://tracing or Perfetto
+bool span_write_json(const char *path);
+
+} // namespace ft232gpio
+
+#define FT232GPIO_SPAN_CAT2(a, b) a##b
+#define FT232GPIO_SPAN_CAT(a, b) FT232GPIO_SPAN_CAT2(a, b)
+
+#if FT232GPIO_SPANS
+#define FT232GPIO_SPAN(name) ::ft232gpio::Span FT232GPIO_SPAN_CAT(_ft232gpio_span_, __LINE__)(name)
+#else
+#define FT232GPIO_SPAN(name) \
+  do                         \
+  {                          \
+  } while (0)
+#endif
+
+#endif // __FT232GPIO_SPAN_H__
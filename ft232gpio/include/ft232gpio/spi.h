@@ -0,0 +1,83 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_SPI_H__
+#define __FT232GPIO_SPI_H__
+
+#include "ft232.h"
+
+#include <vector>
+
+// default pins
+#define SPI_PIN_SCK 0x01  // TXD of FT232
+#define SPI_PIN_MOSI 0x02 // RXD of FT232
+#define SPI_PIN_CS 0x04   // RTS of FT232
+#define SPI_PIN_MISO 0x20 // DSR of FT232
+
+namespace ft232gpio
+{
+
+/**
+ * SPI master, mode 0 ~ 3 with CPOL as bit 1 and CPHA as bit 0.
+ * A transaction is encoded into one buffer of samples with chip select
+ * around it. With MISO it is sent with FT232::transfer() and MISO is taken
+ * from the samples read back, without MISO it is written into the batch.
+ */
+class SPI
+{
+public:
+  SPI() = default;
+  virtual ~SPI() = default;
+
+public:
+  // FT232 pins, set before init(). miso 0 for devices that only receive
+  void pins(uint8_t cs, uint8_t sck, uint8_t mosi, uint8_t miso);
+  uint8_t pin_mask(void) const { return _pin_cs | _pin_sck | _pin_mosi | _pin_miso; }
+
+  bool init(FT232 *ft232, uint8_t mode = 0, bool lsb_first = false);
+  void release(void);
+
+  // full duplex, in may be nullptr. in is all ones without MISO pin
+  bool transfer(const uint8_t *out, uint8_t *in, int32_t length);
+  bool write(const uint8_t *out, int32_t length) { return transfer(out, nullptr, length); }
+
+public:
+  bool initialized(void) { return _initalized; }
+  FT232 *ft232(void) { return _ft232; }
+
+private:
+  uint8_t idle(void) const;
+
+private:
+  FT232 *_ft232 = nullptr;
+  uint8_t _pin_cs = SPI_PIN_CS;
+  uint8_t _pin_sck = SPI_PIN_SCK;
+  uint8_t _pin_mosi = SPI_PIN_MOSI;
+  uint8_t _pin_miso = SPI_PIN_MISO;
+  bool _cpol = false;
+  bool _cpha = false;
+  bool _lsb_first = false;
+  bool _initalized = false;
+
+  // kept to not allocate on every transaction
+  std::vector<uint8_t> _out;
+  std::vector<uint8_t> _in;
+  std::vector<uint32_t> _reads;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_SPI_H__
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_SSD1306_H__
+#define __FT232GPIO_SSD1306_H__
+
+#include "ssd1306_def.h"
+#include "i2c.h"
+
+namespace ft232gpio
+{
+
+/**
+ * SSD1306 OLED, 128x64 or 128x32, on I2C.
+ * Drawing goes to a framebuffer, laid out as GDDRAM with a byte for 8 rows
+ * of a column in a page. Each page keeps the range of columns drawn since
+ * the last present(), and present() sends only those as column/page
+ * windows. Neighbour pages are sent in one window, one data write, when
+ * the extra columns cost less than another window.
+ */
+class SSD1306
+{
+public:
+  explicit SSD1306(int32_t height = 64);
+  virtual ~SSD1306() = default;
+
+public:
+  bool init(I2C *i2c);
+  void release(void);
+
+public:
+  bool initialized(void) { return _initalized; }
+  int32_t width(void) const { return SSD1306_WIDTH; }
+  int32_t height(void) const { return _pages * 8; }
+
+public:
+  // drawing, coordinates out of the panel are clipped
+  void clear(void);
+  void pixel(int32_t x, int32_t y, bool on);
+  bool pixel(int32_t x, int32_t y) const;
+  void line(int32_t x0, int32_t y0, int32_t x1, int32_t y1, bool on = true);
+  void rect(int32_t x, int32_t y, int32_t w, int32_t h, bool fill = false, bool on = true);
+  // 5x7 glyphs with 1 column of space, y is the top row
+  void text(int32_t x, int32_t y, const char *str, bool on = true);
+
+public:
+  // sends the changes drawn since the last present(), in one USB transfer
+  void present(void);
+  uint32_t present_bytes(void) const { return _present_bytes; } // bytes of last present()
+
+  void contrast(uint8_t value);
+  void display(bool enable);
+
+private:
+  void setup(void);
+  void command(const uint8_t *cmds, uint32_t count);
+  void window(int32_t first, int32_t last, int32_t lo, int32_t hi);
+  void dirty(int32_t page, int32_t x);
+  void dirty_all(void);
+  bool trim(int32_t page);
+  void replay(void);
+
+private:
+  I2C *_i2c = nullptr;
+  bool _initalized = false;
+  int32_t _pages = 8;
+  uint8_t _contrast = 0xCF;
+  bool _display = false;
+
+  uint8_t _frame[SSD1306_PAGES_MAX][SSD1306_WIDTH];
+  // what the panel shows, to skip columns drawn back to what was sent
+  uint8_t _panel[SSD1306_PAGES_MAX][SSD1306_WIDTH];
+  bool _panel_valid = false;
+  // columns lo ~ hi-1 of a page are dirty, lo >= hi when clean
+  uint8_t _dirty_lo[SSD1306_PAGES_MAX];
+  uint8_t _dirty_hi[SSD1306_PAGES_MAX];
+  uint32_t _present_bytes = 0;
+  FT232Replay _replay;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_SSD1306_H__
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_SSD1306_DEF_H__
+#define __FT232GPIO_SSD1306_DEF_H__
+
+// clang-format off
+#define SSD1306_ADDR                0x3C // 0x3D with SA0 high
+
+// control byte after the address
+#define SSD1306_CTRL_CMD            0x00 // command stream
+#define SSD1306_CTRL_DATA           0x40 // GDDRAM data stream
+
+#define SSD1306_CMD_CONTRAST        0x81 // + contrast
+#define SSD1306_CMD_RESUME          0xA4 // show GDDRAM
+#define SSD1306_CMD_NORMAL          0xA6 // not inverted
+#define SSD1306_CMD_DISPLAY_OFF     0xAE
+#define SSD1306_CMD_DISPLAY_ON      0xAF
+#define SSD1306_CMD_ADDR_MODE       0x20 // + mode
+#define SSD1306_CMD_COLUMN_ADDR     0x21 // + start, end
+#define SSD1306_CMD_PAGE_ADDR       0x22 // + start, end
+#define SSD1306_CMD_START_LINE      0x40 // | line
+#define SSD1306_CMD_SEG_REMAP       0xA1 // column 127 to SEG0
+#define SSD1306_CMD_MULTIPLEX       0xA8 // + rows - 1
+#define SSD1306_CMD_COM_SCAN_DEC    0xC8 // scan from COM[N-1] to COM0
+#define SSD1306_CMD_OFFSET          0xD3 // + offset
+#define SSD1306_CMD_COM_PINS        0xDA // + config
+#define SSD1306_CMD_CLOCK_DIV       0xD5 // + ratio and frequency
+#define SSD1306_CMD_PRECHARGE       0xD9 // + period
+#define SSD1306_CMD_VCOM_DETECT     0xDB // + level
+#define SSD1306_CMD_CHARGE_PUMP     0x8D // + enable
+
+#define SSD1306_ADDR_MODE_HORIZ     0x00 // column, then next page in the window
+#define SSD1306_CHARGE_PUMP_ON      0x14
+#define SSD1306_COM_PINS_64         0x12 // alternative, for 128x64
+#define SSD1306_COM_PINS_32         0x02 // sequential, for 128x32
+
+#define SSD1306_WIDTH               128
+#define SSD1306_PAGES_MAX           8 // 8 rows of pixels per page
+
+// bytes of a window change, command write with 6 commands and data header
+#define SSD1306_WINDOW_BYTES        10
+// clang-format on
+
+#endif // __FT232GPIO_SSD1306_DEF_H__
@@ -20,19 +20,53 @@
 #include "tm1637_def.h"
 #include "ft232.h"
 
+#include <vector>
+
 namespace ft232gpio
 {
 
+// bus waits in usecs, rounded up to samples of the bitbang clock
+struct TM1637Timing
+{
+  uint32_t clock_usecs; // CLK high and low, and around start and stop
+  uint32_t hold_usecs;  // DIO after CLK falls
+};
+
+static constexpr TM1637Timing TM1637_TIMING_DEFAULT = {20, 20};
+
+// segments of every digit and brightness 0 ~ 8, as bright()
+struct TM1637Frame
+{
+  uint8_t segments[TM1637_DIGITS_MAX];
+  uint8_t bright;
+};
+
 class TM1637
 {
 public:
   TM1637() = default;
+  // digits is clamped to 1 ~ TM1637_DIGITS_MAX
+  explicit TM1637(int32_t digits)
+    : _digits(digits < 1 ? 1 : digits < TM1637_DIGITS_MAX ? digits : TM1637_DIGITS_MAX)
+  {
+  }
   virtual ~TM1637() = default;
 
 public:
+  // FT232 pins for CLK and DIO, set before init() or attach()
+  void pins(uint8_t clock, uint8_t dio);
+  uint8_t pin_mask(void) const { return _pin_clock | _pin_dio; }
+
+  // timing comes from the profile of the adapter and pins if there is one
   bool init(FT232 *ft232);
+  // attach to a module that is already running, eg. on process restart.
+  // sets data mode and brightness without clearing or per command waits.
+  bool attach(FT232 *ft232, uint8_t value);
   void release(void);
 
+  void timing(const TM1637Timing &timing) { _timing = timing; }
+  const TM1637Timing &timing(void) const { return _timing; }
+
   void write(uint8_t data);
   void writes(uint8_t *data, int32_t length);
   void bright(uint8_t value);
@@ -40,11 +74,39 @@ public:
 
   void digits(uint8_t data[4], bool colon);
   void test(void);
+  // segments of every digit, 4 or 6. only digits that differ from the
+  // registers are sent, with auto increment runs or fixed address writes
+  // whichever takes fewer bus bits.
+  void update(const uint8_t *data);
+
+  // waveform that sets all digits and brightness of the frame, it does not
+  // depend on the state before so any frame can follow any other. it holds
+  // only CLK and DIO, other pins are 0.
+  std::vector<uint8_t> encode(const TM1637Frame &frame);
+  // sends a waveform from encode() with other pins as they are now, frame
+  // is what it shows. state changes hold the port lock, so update() and
+  // digits() may run on another thread, the later one wins.
+  bool show(const std::vector<uint8_t> &wave, const TM1637Frame &frame);
+
+  // reads key scan code, TM1637_KEY_NONE when no key is pressed
+  uint8_t keyscan(void);
+  // sends the display command again and reads its acknowledge, true when
+  // TM1637 pulled DIO low
+  bool probe(void);
+  // key 0 ~ 7 for K1 + SG1 ~ SG8, 8 ~ 15 for K2 + SG1 ~ SG8, -1 for none
+  static int8_t key_index(uint8_t code);
 
 public:
   bool initialized(void) { return _initalized; }
+  int32_t digit_count(void) const { return _digits; }
+  uint32_t init_usecs(void) const { return _init_usecs; } // last init/attach time
 
 private:
+  void replay(void);
+  void command(uint8_t data);
+  void data_mode(uint8_t mode);
+  uint8_t bright_command(uint8_t value);
+  void set_pins(bool clock, bool dio);
   void dio_start(void);
   void dio_stop(void);
   void write_byte(uint8_t b);
@@ -52,7 +114,20 @@ private:
 
 private:
   FT232 *_ft232 = nullptr;
+  uint8_t _pin_clock = TM1637_PIN_CLOCK;
+  uint8_t _pin_dio = TM1637_PIN_DIO;
   bool _initalized = false;
+  uint32_t _init_usecs = 0;
+  int32_t _digits = 4;
+  TM1637Timing _timing = TM1637_TIMING_DEFAULT;
+
+  // last known state, for partial update and replay
+  uint8_t _segments[TM1637_DIGITS_MAX] = {0};
+  bool _segments_valid = false; // registers are known to hold _segments
+  uint8_t _data_cmd = TM1637_CMD_DATA | TM1637_DATA_READ; // unknown, forces a data command
+  uint8_t _display_cmd = TM1637_CMD_DISPLAY | TM1637_DISPLAY_OFF;
+  FT232Replay _replay;
+  std::vector<uint8_t> _wave; // show() with other pins merged
 };
 
 /**
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_TM1637_ANIM_H__
+#define __FT232GPIO_TM1637_ANIM_H__
+
+#include "tm1637.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace ft232gpio
+{
+
+/**
+ * Plays frames on a TM1637 at a fixed frame rate from a background thread.
+ * Frames are encoded to waveforms once by load(), each frame only submits
+ * its buffer. Frame times are fixed from start(), when the bus is slow late
+ * frames are skipped so the animation keeps its pace.
+ */
+class TM1637Animation
+{
+public:
+  TM1637Animation() = default;
+  virtual ~TM1637Animation();
+
+public:
+  bool load(TM1637 *tm1637, const std::vector<TM1637Frame> &frames);
+  // loop false stops after the last frame, which stays on the display
+  bool start(uint32_t fps, bool loop = true);
+  void stop(void);
+
+public:
+  bool running(void) const { return _running; }
+  uint32_t shown(void) const { return _shown; }
+  uint32_t skipped(void) const { return _skipped; }
+
+private:
+  void run(void);
+
+private:
+  TM1637 *_tm1637 = nullptr;
+  std::vector<TM1637Frame> _frames;
+  std::vector<std::vector<uint8_t>> _waves;
+
+  std::chrono::nanoseconds _period{0};
+  bool _loop = true;
+
+  std::thread _thread;
+  std::atomic<bool> _running{false};
+  std::atomic<uint32_t> _shown{0};
+  std::atomic<uint32_t> _skipped{0};
+};
+
+// frames of text moving left through the digits, starts and ends blank
+std::vector<TM1637Frame> tm1637_scroll(const char *text, int32_t digits, uint8_t bright);
+// brightness from one value to another, one frame per step
+std::vector<TM1637Frame> tm1637_fade(const uint8_t segments[TM1637_DIGITS_MAX], uint8_t from,
+                                     uint8_t to);
+// one segment running around the outside of a digit, others blank. no
+// frames when digit is out of range
+std::vector<TM1637Frame> tm1637_spinner(int32_t digit, uint8_t bright);
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_TM1637_ANIM_H__
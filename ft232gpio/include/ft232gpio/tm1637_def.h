@@ -42,6 +42,16 @@
 #define TM1637_ADDR_C4H 0x04 // 0b---- 0100
 #define TM1637_ADDR_C5H 0x05 // 0b---- 0101
 
+// key scan code read with TM1637_DATA_READ, K1 0xF7 ~ 0xF0, K2 0xEF ~ 0xE8
+// for SG1 ~ SG8, no key pressed reads all ones
+#define TM1637_KEY_NONE 0xFF
+
+#define TM1637_DIGITS_MAX 6 // segment registers C0H ~ C5H
+
 #define TM1637_DBIT_COLON 0x80 // colon led on if given
 
+// default pins
+#define TM1637_PIN_CLOCK 0x08 // CTS of FT232
+#define TM1637_PIN_DIO 0x10   // DTR of FT232
+
 #endif // __FT232GPIO_TM1637_DEF_H__
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_TM1637_KEYS_H__
+#define __FT232GPIO_TM1637_KEYS_H__
+
+#include "tm1637.h"
+#include "event.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+namespace ft232gpio
+{
+
+struct KeyEvent
+{
+  int8_t key;   // TM1637::key_index()
+  bool pressed; // true for press, false for release
+  std::chrono::steady_clock::time_point time;
+};
+
+/**
+ * Polls TM1637 key scan on a background thread, debounces and sends press
+ * and release events to the callback or to the queue. TM1637 reports only
+ * one key at a time, pressing another key releases the previous one.
+ */
+class TM1637Keys
+{
+public:
+  TM1637Keys() = default;
+  virtual ~TM1637Keys();
+
+public:
+  // debounce is number of equal scans to accept a change
+  bool start(TM1637 *tm1637, uint32_t interval_ms = 10, uint32_t debounce = 2);
+  void stop(void);
+
+public:
+  // callback runs on the polling thread, events are queued when not set
+  void on_key(std::function<void(const KeyEvent &)> callback);
+  bool poll(KeyEvent &event) { return _queue.poll(event); }
+  bool wait(KeyEvent &event, uint32_t timeout_ms) { return _queue.wait(event, timeout_ms); }
+
+private:
+  void run(void);
+  void emit(int8_t key, bool pressed, std::chrono::steady_clock::time_point time);
+
+private:
+  TM1637 *_tm1637 = nullptr;
+  std::chrono::microseconds _interval{0};
+  uint32_t _debounce = 0;
+
+  std::thread _thread;
+  std::atomic<bool> _running{false};
+
+  std::mutex _callback_mutex;
+  std::function<void(const KeyEvent &)> _callback;
+  EventQueue<KeyEvent> _queue;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_TM1637_KEYS_H__
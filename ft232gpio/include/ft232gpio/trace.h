@@ -0,0 +1,82 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_TRACE_H__
+#define __FT232GPIO_TRACE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#define TRACE_CAPACITY (1 << 20) // samples, 16MB
+
+namespace ft232gpio
+{
+
+struct TraceSample
+{
+  uint64_t nsecs; // intended time since the first sample
+  uint8_t value;
+};
+
+struct TraceStats
+{
+  uint64_t transfers = 0;
+  uint64_t samples = 0;
+  uint64_t idle_nsecs = 0; // port held between transfers
+  uint64_t dropped = 0;    // oldest samples overwritten
+};
+
+/**
+ * Samples the adapter was given, with the time each is meant to be on the
+ * port. FT232::tap() feeds it with every USB write. A transfer starts when
+ * it is written or when the one before it ends, whichever is later, and
+ * its samples follow at the sample rate. The ring keeps the latest
+ * capacity samples.
+ */
+class Trace
+{
+public:
+  explicit Trace(size_t capacity = TRACE_CAPACITY);
+  virtual ~Trace() = default;
+
+public:
+  // from FT232 for each USB write
+  void record(const uint8_t *buf, size_t size, uint32_t sample_rate);
+  void clear(void);
+
+  TraceStats stats(void);
+  std::vector<TraceSample> snapshot(void);
+  // names are for D0 ~ D7, nullptr for VCD_PIN_NAMES
+  bool write_vcd(const char *path, uint8_t mask = 0xFF, const char *const *names = nullptr);
+
+private:
+  std::mutex _mutex;
+  std::vector<TraceSample> _ring;
+  size_t _head = 0; // next to write
+  size_t _size = 0;
+  TraceStats _stats;
+  uint32_t _sample_rate = 1; // of the last transfer, for VCD time
+  bool _started = false;
+  int64_t _start = 0; // steady clock ns of the first sample
+  uint64_t _next = 0; // intended time after the last sample
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_TRACE_H__
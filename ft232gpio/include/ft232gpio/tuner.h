@@ -0,0 +1,71 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __FT232GPIO_TUNER_H__
+#define __FT232GPIO_TUNER_H__
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ft232gpio
+{
+
+// timing value to shorten, eg. a field of I2CTiming
+struct TuneParam
+{
+  const char *name;
+  uint32_t *usecs;
+};
+
+/**
+ * Finds how short bus waits can be for a device. check() applies the
+ * values to the driver and tells whether the device still works, eg. by
+ * its acknowledge or what a device model shows. One value at a time is
+ * halved while checks pass, then the limit is searched between the last
+ * pass and the first fail. Every value then gets the margin on top, but
+ * never more than it started with. Values as given must pass.
+ */
+class TimingTuner
+{
+public:
+  explicit TimingTuner(std::function<bool(void)> check) : _check(std::move(check)) {}
+
+public:
+  void margin(uint32_t percent) { _margin = percent; }
+  // checks per candidate, all must pass
+  void repeat(uint32_t count) { _repeat = count ? count : 1; }
+
+  // false when the values as given or the final values fail, values are
+  // restored then
+  bool tune(const std::vector<TuneParam> &params);
+  uint32_t checks(void) const { return _checks; }
+
+private:
+  bool passes(void);
+  uint32_t limit(uint32_t *usecs);
+
+private:
+  std::function<bool(void)> _check;
+  uint32_t _margin = 50;
+  uint32_t _repeat = 4;
+  uint32_t _checks = 0;
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_TUNER_H__
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FT232GPIO_VCD_H__
+#define __FT232GPIO_VCD_H__
+
+#include <cstdint>
+#include <cstdio>
+
+namespace ft232gpio
+{
+
+// names of FT232R bitbang pins D0 ~ D7
+extern const char *const VCD_PIN_NAMES[8];
+
+/**
+ * Writes samples of the 8 bitbang pins as a VCD file, one wire for each
+ * pin in mask. Only changes are written. Time is in samples, written in ns.
+ */
+class VCDWriter
+{
+public:
+  VCDWriter() = default;
+  virtual ~VCDWriter();
+
+public:
+  // names are for D0 ~ D7, nullptr for VCD_PIN_NAMES
+  bool open(const char *path, uint32_t sample_rate, uint8_t mask,
+            const char *const *names = nullptr);
+  void close(void);
+
+  void sample(uint64_t index, uint8_t value);
+  void samples(uint64_t index, const uint8_t *values, uint32_t count);
+
+public:
+  bool is_open(void) const { return _file != nullptr; }
+
+private:
+  void change(uint64_t index, uint8_t value);
+
+private:
+  FILE *_file = nullptr;
+  uint32_t _sample_rate = 1;
+  uint8_t _mask = 0x00;
+  uint8_t _last = 0x00;
+  bool _first = true;
+  uint64_t _end = 0; // index after the last sample
+};
+
+} // namespace ft232gpio
+
+#endif // __FT232GPIO_VCD_H__
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ft232gpio/capture.h"
+#include "ft232gpio/log.h"
+
+#include <chrono>
+
+namespace ft232gpio
+{
+
+Capture::~Capture()
+{
+  //
+  stop();
+}
+
+bool Capture::start(FT232 *ft232, const char *path, uint8_t pins, const CaptureTrigger &trigger,
+                    uint32_t rate, uint64_t count)
+{
+  if (_running || _reader.joinable())
+    return false;
+
+  _ft232 = ft232;
+  _pins = pins;
+  _trigger = trigger;
+  _count = count;
+
+  _rate = 0;
+  if (rate && rate != _ft232->sample_rate())
+  {
+    _rate = _ft232->sample_rate();
+    _ft232->set_sample_rate(rate);
+  }
+  if (not _vcd.open(path, _ft232->sample_rate(), _pins))
+  {
+    if (_rate)
+      _ft232->set_sample_rate(_rate);
+    return false;
+  }
+
+  _inputs = _ft232->inputs();
+  _ft232->inputs(_inputs | _pins);
+
+  if (not _ring)
+    _ring.reset(new RingQueue<Block, CAPTURE_RING>());
+  _has_prev = false;
+  _triggered = trigger.type == CaptureTrigger::NONE;
+  _trigger_index = 0;
+  _written = 0;
+  _overruns = 0;
+
+  _ft232->purge_samples();
+  _running = true;
+  _reading = true;
+  _writer = std::thread(&Capture::write_loop, this);
+  _reader = std::thread(&Capture::read_loop, this);
+  return true;
+}
+
+void Capture::stop(void)
+{
+  if (not _reader.joinable())
+    return;
+
+  _running = false;
+  _reader.join();
+  _writer.join();
+  _vcd.close();
+
+  _ft232->inputs(_inputs);
+  if (_rate)
+    _ft232->set_sample_rate(_rate);
+
+  if (_overruns)
+    FT232GPIO_WARN("Capture overrun, %llu samples dropped", (unsigned long long)_overruns.load());
+}
+
+//
+// Capture privates
+//
+
+void Capture::read_loop(void)
+{
+  uint64_t index = 0;
+  uint8_t scratch[CAPTURE_BLOCK];
+
+  while (_running)
+  {
+    int got = 0;
+    bool queued = _ring->push_with([&](Block &block) {
+      got = _ft232->read_samples(block.data, CAPTURE_BLOCK);
+      block.index = index;
+      block.count = got > 0 ? got : 0;
+    });
+    if (not queued)
+    {
+      // writer is behind, keep reading so the adapter does not stall
+      got = _ft232->read_samples(scratch, CAPTURE_BLOCK);
+      if (got > 0)
+        _overruns += got;
+    }
+    if (got < 0)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10)); // reconnecting
+      continue;
+    }
+    if (got == 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1)); // nothing yet
+    index += got;
+  }
+  _reading = false;
+}
+
+void Capture::write_loop(void)
+{
+  auto take = [this](Block &block) { write_block(block); };
+
+  while (true)
+  {
+    if (_ring->pop_with(take))
+      continue;
+    if (not _reading)
+      break; // reader has finished and ring is empty
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+void Capture::write_block(const Block &block)
+{
+  if (block.count == 0 || (_count && _written >= _count))
+    return;
+
+  uint32_t offset = 0;
+  if (not _triggered)
+  {
+    int64_t found = trigger(block);
+    if (found < 0)
+      return;
+    offset = found;
+    _trigger_index = block.index + offset;
+    _triggered = true;
+    FT232GPIO_INFO("Capture triggered at sample %llu", (unsigned long long)_trigger_index);
+  }
+
+  uint32_t count = block.count - offset;
+  if (_count && _written + count > _count)
+    count = _count - _written;
+
+  // VCD time starts at the trigger
+  _vcd.samples(block.index + offset - _trigger_index, block.data + offset, count);
+  _written += count;
+
+  if (_count && _written >= _count)
+    _running = false;
+}
+
+int64_t Capture::trigger(const Block &block)
+{
+  const uint8_t mask = _trigger.mask;
+  for (uint32_t i = 0; i < block.count; ++i)
+  {
+    uint8_t value = block.data[i];
+    bool hit = false;
+    switch (_trigger.type)
+    {
+      case CaptureTrigger::NONE:
+        hit = true;
+        break;
+      case CaptureTrigger::RISING:
+        hit = _has_prev && !(_prev & mask) && (value & mask);
+        break;
+      case CaptureTrigger::FALLING:
+        hit = _has_prev && (_prev & mask) && !(value & mask);
+        break;
+      case CaptureTrigger::EDGE:
+        hit = _has_prev && ((_prev ^ value) & mask);
+        break;
+      case CaptureTrigger::PATTERN:
+        hit = (value & mask) == (_trigger.value & mask);
+        break;
+    }
+    _prev = value;
+    _has_prev = true;
+    if (hit)
+      return i;
+  }
+  return -1;
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ft232gpio/compositor.h"
+#include "ft232gpio/log.h"
+
+namespace ft232gpio
+{
+
+bool FT232Compositor::lane(uint8_t mask, std::function<void(void)> send)
+{
+  if (mask & _used)
+  {
+    FT232GPIO_ERROR("FT232Compositor lane pins 0x%02x overlap 0x%02x", mask, _used);
+    return false;
+  }
+
+  // record keeps the port as it was, every lane starts from the same state
+  _ft232->record_begin();
+  send();
+  _lanes.push_back({mask, _ft232->record_end()});
+  _used |= mask;
+  _pending = true;
+  return true;
+}
+
+bool FT232Compositor::run(void)
+{
+  _pending = false;
+  size_t length = samples();
+  if (length == 0)
+  {
+    clear();
+    return true;
+  }
+
+  FT232Batch batch(_ft232);
+
+  std::vector<uint8_t> stream(length, _ft232->port() & ~_used);
+  for (auto &lane : _lanes)
+  {
+    if (lane.samples.empty())
+    {
+      for (auto &sample : stream)
+        sample |= _ft232->port() & lane.mask;
+      continue;
+    }
+    size_t s = 0;
+    for (; s < lane.samples.size(); ++s)
+      stream[s] |= lane.samples[s] & lane.mask;
+    uint8_t last = lane.samples.back() & lane.mask;
+    for (; s < length; ++s)
+      stream[s] |= last;
+  }
+  clear();
+
+  _ft232->write_data(stream.data(), stream.size());
+  return batch.end();
+}
+
+void FT232Compositor::clear(void)
+{
+  if (_pending)
+  {
+    // drivers hold state that was never sent
+    FT232GPIO_WARN("FT232Compositor lanes cleared without run, replaying drivers");
+    _ft232->replay();
+  }
+  _lanes.clear();
+  _used = 0x00;
+  _pending = false;
+}
+
+size_t FT232Compositor::samples(void) const
+{
+  size_t length = 0;
+  for (auto &lane : _lanes)
+    length = lane.samples.size() > length ? lane.samples.size() : length;
+  return length;
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ft232gpio/ds18b20.h"
+#include "ft232gpio/log.h"
+
+#include <cassert>
+
+#include <unistd.h> // usleep
+
+#define SCRATCHPAD_SIZE 9
+
+namespace ft232gpio
+{
+
+bool DS18B20::init(OneWire *onewire)
+{
+  _onewire = onewire;
+
+  if (not _onewire->search(_roms, DS18B20_FAMILY))
+  {
+    FT232GPIO_WARN("DS18B20 search failed");
+    return false;
+  }
+  for (auto rom : _roms)
+    FT232GPIO_INFO("DS18B20 %016llx", (unsigned long long)rom);
+
+  return not _roms.empty();
+}
+
+void DS18B20::release(void)
+{
+  _roms.clear();
+  _onewire = nullptr;
+}
+
+bool DS18B20::convert(void)
+{
+  if (_onewire == nullptr)
+  {
+    assert(false);
+    return false;
+  }
+
+  // every sensor at once
+  _onewire->reset();
+  _onewire->write_byte(ONEWIRE_SKIP_ROM);
+  _onewire->write_byte(DS18B20_CONVERT_T);
+  return _onewire->commit();
+}
+
+bool DS18B20::read(std::vector<int32_t> &millis)
+{
+  if (_onewire == nullptr)
+  {
+    assert(false);
+    return false;
+  }
+
+  // select each sensor in turn, all in one transfer
+  for (auto rom : _roms)
+  {
+    uint8_t match[9];
+    match[0] = ONEWIRE_MATCH_ROM;
+    for (int32_t i = 0; i < 8; ++i)
+      match[1 + i] = rom >> (8 * i);
+
+    _onewire->reset();
+    _onewire->write(match, 9);
+    _onewire->write_byte(DS18B20_READ_SCRATCHPAD);
+    _onewire->read(SCRATCHPAD_SIZE);
+  }
+  _scratch.resize(_roms.size() * SCRATCHPAD_SIZE);
+  bool ok = _onewire->commit(_scratch.data());
+
+  millis.resize(_roms.size());
+  for (size_t s = 0; s < _roms.size(); ++s)
+  {
+    const uint8_t *pad = _scratch.data() + s * SCRATCHPAD_SIZE;
+    if (not ok || OneWire::crc8(pad, SCRATCHPAD_SIZE - 1) != pad[SCRATCHPAD_SIZE - 1])
+    {
+      millis[s] = DS18B20_INVALID;
+      ok = false;
+      continue;
+    }
+    // 1/16 degree in two's complement
+    int16_t raw = int16_t(pad[1] << 8 | pad[0]);
+    millis[s] = int32_t(raw) * 125 / 2;
+  }
+  return ok;
+}
+
+bool DS18B20::measure(std::vector<int32_t> &millis)
+{
+  if (not convert())
+    return false;
+  usleep(DS18B20_CONVERT_MSEC * 1000);
+  return read(millis);
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/expander.h"
+#include "ft232gpio/log.h"
+
+#include <cassert>
+
+namespace ft232gpio
+{
+
+Expander::Expander(int32_t bits)
+{
+  //
+  _bytes = bits > 8 ? 2 : 1;
+}
+
+bool Expander::init(I2C *i2c, uint16_t port)
+{
+  FT232GPIO_DEBUG("Expander::init %d bits", bits());
+
+  _i2c = i2c;
+  _port = port;
+  _replay.add(_i2c->ft232(), [this] { replay(); });
+  _initalized = true;
+
+  return send(&_port, 1, 0);
+}
+
+void Expander::release(void)
+{
+  if (_i2c == nullptr)
+  {
+    assert(false);
+    return;
+  }
+  _replay.remove();
+
+  // all pins back to inputs
+  _port = 0xFFFF;
+  send(&_port, 1, 0);
+
+  _i2c = nullptr;
+  _initalized = false;
+}
+
+void Expander::inputs(uint16_t mask)
+{
+  //
+  _inputs = mask;
+}
+
+void Expander::write(uint16_t value)
+{
+  //
+  write(0xFFFF, value);
+}
+
+void Expander::write(uint16_t mask, uint16_t value)
+{
+  if (not _initalized)
+  {
+    assert(false);
+    return;
+  }
+
+  uint16_t port = (_port & ~mask) | (value & mask);
+  if (port == _port)
+    return;
+
+  _port = port;
+  send(&_port, 1, 0);
+}
+
+void Expander::sequence(const uint16_t *values, uint32_t count, uint32_t hold_usecs)
+{
+  if (not _initalized)
+  {
+    assert(false);
+    return;
+  }
+  if (count == 0)
+    return;
+
+  _port = values[count - 1];
+  send(values, count, hold_usecs);
+}
+
+bool Expander::read(uint16_t &value)
+{
+  if (not _initalized)
+  {
+    assert(false);
+    return false;
+  }
+
+  // P7~P0 and then P17~P10 on PCF8575
+  uint8_t data[2] = {0xFF, 0xFF};
+  if (not _i2c->read(data, _bytes))
+    return false;
+  value = data[0] | (_bytes == 2 ? data[1] << 8 : 0);
+  return true;
+}
+
+bool Expander::send(const uint16_t *values, uint32_t count, uint32_t hold_usecs)
+{
+  FT232Batch batch(_i2c->ft232());
+
+  // clock stays low between bytes while holding, which I2C allows
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    bool last = i + 1 == count;
+    uint16_t value = values[i] | _inputs;
+
+    if (_bytes == 1)
+      _i2c->write_byte(i == 0, last, value & 0xFF);
+    else
+    {
+      _i2c->write_byte(i == 0, false, value & 0xFF);
+      _i2c->write_byte(false, last, value >> 8);
+    }
+    if (hold_usecs && not last)
+      _i2c->ft232()->delay(hold_usecs);
+  }
+  return batch.end();
+}
+
+void Expander::replay(void)
+{
+  // I2C has reset the bus before, it was added first
+  send(&_port, 1, 0);
+}
+
+} // namespace ft232gpio
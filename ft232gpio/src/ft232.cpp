@@ -16,87 +16,668 @@
 
 #include "ft232gpio/ft232.h"
 
-#include <iostream>
+#include "ft232gpio/log.h"
+#include "ft232gpio/span.h"
+#include "ft232gpio/trace.h"
+
+#include <algorithm>
+#include <chrono>
 
 #include <unistd.h> // usleep
 
+#define FT232_VID 0x0403
+#define FT232_PID 0x6001
+
+// AN232R-01: asynchronous bitbang clocks data at 16 times the baud rate,
+// 9600 baud gives 153600 samples per second or one sample every 6.5us.
+// baud rate is set before bitbang is enabled, as libftdi scales it after.
+#define FT232_BAUDRATE 9600
+#define FT232_BITBANG_CLOCK 16
+
+// synchronous bitbang fills a 256 byte receive buffer, stay well below it
+#define FT232_SYNC_CHUNK 128
+#define FT232_READ_RETRY 100
+
+// reconnect backoff
+#define RECONNECT_DELAY_MIN 10   // msec
+#define RECONNECT_DELAY_MAX 1000 // msec
+
 namespace ft232gpio
 {
 
-FT232::FT232()
+FT232::FT232() : _baudrate(FT232_BAUDRATE)
 {
   //
 }
 
 FT232::~FT232()
 {
-  //
+  // a derived adapter calls release() itself, while its usb_* are there
+  release();
 }
 
 bool FT232::init(void)
 {
-  if ((_ftdi = ::ftdi_new()) == 0)
-  {
-    std::cerr << "ftdi_new failed" << std::endl;
-    return false;
-  }
+  FT232GPIO_SPAN("FT232::init");
 
-  int fd_usb = ::ftdi_usb_open(_ftdi, 0x0403, 0x6001);
-  if (fd_usb < 0 && fd_usb != -5)
-  {
-    auto msg = ::ftdi_get_error_string(_ftdi);
-    std::cerr << "Unable to open ftdi device: " << fd_usb << " (" << msg << ")" << std::endl;
-    ::ftdi_free(_ftdi);
-    _ftdi = nullptr;
+  if (not usb_init())
     return false;
-  }
-  if (::ftdi_set_bitmode(_ftdi, 0xFF, BITMODE_BITBANG))
+  _usb_ready = true;
+
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+  if (!open())
   {
-    std::cerr << "Failed to set bitbang mode" << std::endl;
-    ::ftdi_free(_ftdi);
-    _ftdi = nullptr;
+    usb_deinit();
+    _usb_ready = false;
     return false;
   }
+  _connected = true;
+  _reconnect_stop = false;
   return true;
 }
 
 void FT232::release(void)
 {
-  if (_ftdi == nullptr)
+  if (not _usb_ready)
     return;
 
-  ::ftdi_disable_bitbang(_ftdi);
-  ::ftdi_usb_close(_ftdi);
-  ::ftdi_free(_ftdi);
-  _ftdi = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(_reconnect_mutex);
+    _reconnect_stop = true;
+  }
+  _reconnect_cv.notify_all();
+  if (_reconnect_thread.joinable())
+    _reconnect_thread.join();
+
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+  if (_connected)
+  {
+    usb_mode(0x00, BITMODE_RESET);
+    close();
+  }
+  usb_deinit();
+  _usb_ready = false;
+  _connected = false;
 }
 
 bool FT232::write_data(const uint8_t *buf, int size)
 {
-  auto f = ::ftdi_write_data(_ftdi, buf, size);
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+
+  if (size > 0)
+    _port = buf[size - 1];
+
+  if (_batch_depth > 0)
+  {
+    _batch.insert(_batch.end(), buf, buf + size);
+    return true;
+  }
+  if (not _connected)
+    return false;
+
+  FT232GPIO_SPAN("FT232::usb_write");
+  emitted(buf, size);
+  auto f = usb_write(buf, size);
   if (f < 0)
   {
-    std::cerr << "write_data failed: " << ::ftdi_get_error_string(_ftdi) << std::endl;
+    FT232GPIO_ERROR("write_data failed: %s", usb_error());
+    lost();
     return false;
   }
   return true;
 }
 
+bool FT232::write_pins(uint8_t mask, uint8_t value)
+{
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+
+  uint8_t data = (_port & ~mask) | (value & mask);
+  return write_data(&data, 1);
+}
+
+bool FT232::inputs(uint8_t mask)
+{
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+
+  // pending samples go out with the directions they were made for, the new
+  // directions are set again on reconnect
+  bool ok = flush();
+  _outputs = 0xFF & ~mask;
+  if (not ok)
+    return false;
+  if (not usb_mode(_outputs, BITMODE_BITBANG))
+  {
+    FT232GPIO_ERROR("Failed to set pin directions: %s", usb_error());
+    lost();
+    return false;
+  }
+  return true;
+}
+
+FT232Transfer FT232::write_submit(uint8_t *buf, int size)
+{
+  FT232GPIO_SPAN("FT232::write_submit");
+
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+
+  FT232Transfer transfer;
+  transfer.connection = _connection;
+
+  // pending writes go out first to keep the order
+  if (not flush() || size <= 0)
+    return transfer;
+
+  emitted(buf, size);
+  auto control = usb_submit(buf, size);
+  if (control == nullptr)
+  {
+    FT232GPIO_ERROR("write_submit failed: %s", usb_error());
+    lost();
+    return transfer;
+  }
+  _submitted.push_back(control);
+  _port = buf[size - 1];
+  transfer.control = control;
+  return transfer;
+}
+
+bool FT232::write_wait(const FT232Transfer &transfer)
+{
+  FT232GPIO_SPAN("FT232::write_wait");
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+
+    // close() has finished transfers of an earlier connection
+    if (transfer.control == nullptr || transfer.connection != _connection)
+      return false;
+    auto it = std::find(_submitted.begin(), _submitted.end(), transfer.control);
+    if (it == _submitted.end())
+      return false;
+    _submitted.erase(it);
+
+    // close() waits for this wait before closing the handle
+    std::lock_guard<std::mutex> wait_lock(_wait_mutex);
+    _waiting++;
+  }
+
+  // without the port lock, other threads write meanwhile
+  bool ok = usb_done(transfer.control) >= 0;
+  {
+    std::lock_guard<std::mutex> wait_lock(_wait_mutex);
+    _waiting--;
+  }
+  _wait_cv.notify_all();
+  if (ok)
+    return true;
+
+  FT232GPIO_ERROR("write_wait failed");
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+  if (transfer.connection == _connection)
+    lost();
+  return false;
+}
+
+int FT232::read_samples(uint8_t *buf, int size)
+{
+  FT232GPIO_SPAN("FT232::read_samples");
+
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+
+  if (not _connected)
+    return -1;
+
+  int f = usb_read(buf, size);
+  if (f < 0)
+  {
+    FT232GPIO_ERROR("read_samples failed: %s", usb_error());
+    lost();
+  }
+  return f;
+}
+
+bool FT232::purge_samples(void)
+{
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+
+  if (not _connected)
+    return false;
+  return usb_purge();
+}
+
 bool FT232::read_data(uint8_t *buf)
 {
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+
+  // pending writes go out before the pins are sampled
+  if (not flush())
+    return false;
+
   // bits = which bits to read
-  ::ftdi_set_bitmode(_ftdi, 0x00, BITMODE_BITBANG);
+  usb_mode(0x00, BITMODE_BITBANG);
   usleep(10);
-  auto f = ::ftdi_read_pins(_ftdi, buf);
+  auto f = usb_pins(buf);
   usleep(10);
-  ::ftdi_set_bitmode(_ftdi, 0xff, BITMODE_BITBANG);
+  usb_mode(_outputs, BITMODE_BITBANG);
   usleep(10);
   if (f < 0)
   {
-    std::cerr << "read_data failed: " << ::ftdi_get_error_string(_ftdi) << std::endl;
+    FT232GPIO_ERROR("read_data failed: %s", usb_error());
+    lost();
+    return false;
+  }
+  return true;
+}
+
+bool FT232::transfer(const uint8_t *out, uint8_t *in, int size, uint8_t outputs,
+                     const std::vector<uint32_t> *breaks)
+{
+  FT232GPIO_SPAN("FT232::transfer");
+
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+
+  if (not flush())
+    return false;
+
+  if (not usb_mode(outputs & _outputs, BITMODE_SYNCBB))
+  {
+    FT232GPIO_ERROR("Failed to set sync bitbang mode: %s", usb_error());
+    lost();
+    return false;
+  }
+  usb_purge();
+
+  // device stops clocking when its receive buffer is full, so read back
+  // each chunk before writing the next one. pins hold the last sample of a
+  // chunk meanwhile, with breaks chunks end only where that does no harm.
+  bool ok = true;
+  size_t next_break = 0;
+  for (int offset = 0, chunk = 0; ok && offset < size; offset += chunk)
+  {
+    chunk = size - offset < FT232_SYNC_CHUNK ? size - offset : FT232_SYNC_CHUNK;
+    if (breaks && chunk < size - offset)
+    {
+      int end = 0;
+      while (next_break < breaks->size() && int((*breaks)[next_break]) <= offset + chunk)
+        end = (*breaks)[next_break++];
+      chunk = end > offset ? end - offset : chunk;
+    }
+    emitted(out + offset, chunk);
+    if (usb_write(out + offset, chunk) < 0)
+    {
+      ok = false;
+      break;
+    }
+    int got = 0;
+    for (int retry = 0; got < chunk && retry < FT232_READ_RETRY; ++retry)
+    {
+      int f = usb_read(in + offset + got, chunk - got);
+      if (f < 0)
+      {
+        ok = false;
+        break;
+      }
+      got += f;
+    }
+    if (got < chunk)
+      ok = false;
+  }
+  if (size > 0)
+    _port = out[size - 1];
+
+  if (not ok)
+  {
+    FT232GPIO_ERROR("transfer failed: %s", usb_error());
+    lost();
     return false;
   }
+  usb_mode(_outputs, BITMODE_BITBANG);
   return true;
 }
 
+void FT232::batch_begin(void)
+{
+  _lock.lock();
+  _batch_depth++;
+}
+
+bool FT232::batch_end(void)
+{
+  bool ok = true;
+  if (--_batch_depth == 0)
+    ok = flush();
+  _lock.unlock();
+  return ok;
+}
+
+void FT232::delay(uint32_t usecs)
+{
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+
+  if (_batch_depth == 0)
+  {
+    FT232GPIO_SPAN("FT232::usleep");
+    usleep(usecs);
+    return;
+  }
+  // hold the last sample for the time, rounded up to whole samples
+  _batch.insert(_batch.end(), samples(usecs), _port);
+}
+
+uint32_t FT232::sample_rate(void) const
+{
+  //
+  return _baudrate * FT232_BITBANG_CLOCK;
+}
+
+bool FT232::set_sample_rate(uint32_t rate)
+{
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+
+  // pending samples go out at the rate they were made for
+  bool ok = flush();
+  uint32_t baudrate = rate / FT232_BITBANG_CLOCK;
+  _baudrate = baudrate > 0 ? baudrate : 1;
+  if (not ok)
+    return false; // set on reconnect
+
+  // same order as open(), libftdi scales the baud rate in bitbang mode
+  usb_mode(0x00, BITMODE_RESET);
+  if (not usb_baudrate(_baudrate) || not usb_mode(_outputs, BITMODE_BITBANG))
+  {
+    FT232GPIO_ERROR("Failed to set sample rate: %s", usb_error());
+    lost();
+    return false;
+  }
+  return true;
+}
+
+uint32_t FT232::samples(uint32_t usecs) const
+{
+  uint64_t count = (uint64_t(usecs) * sample_rate() + 999999) / 1000000;
+  return count > 0 ? uint32_t(count) : 1;
+}
+
+void FT232::record_begin(void)
+{
+  batch_begin();
+  _records.emplace_back(_batch.size(), _port);
+}
+
+std::vector<uint8_t> FT232::record_end(void)
+{
+  auto record = _records.back();
+  _records.pop_back();
+
+  std::vector<uint8_t> samples(_batch.begin() + record.first, _batch.end());
+  _batch.resize(record.first);
+  _port = record.second;
+
+  batch_end();
+  return samples;
+}
+
+void FT232::tap(Trace *trace)
+{
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+  _tap = trace;
+}
+
+int32_t FT232::add_replay(std::function<void(void)> replay)
+{
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+  _replays[++_replay_id] = std::move(replay);
+  return _replay_id;
+}
+
+void FT232::remove_replay(int32_t id)
+{
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+  _replays.erase(id);
+}
+
+bool FT232::replay(void)
+{
+  FT232Batch batch(this);
+  for (auto &replay : _replays)
+    replay.second();
+  return batch.end();
+}
+
+//
+// FT232 privates
+//
+
+bool FT232::open(void)
+{
+  if (not usb_open())
+    return false;
+  if (not usb_baudrate(_baudrate))
+  {
+    FT232GPIO_ERROR("Failed to set baudrate");
+    usb_close();
+    return false;
+  }
+  if (not usb_mode(_outputs, BITMODE_BITBANG))
+  {
+    FT232GPIO_ERROR("Failed to set bitbang mode");
+    usb_close();
+    return false;
+  }
+  _serial = usb_serial();
+  return true;
+}
+
+void FT232::close(void)
+{
+  // transfers in flight belong to the handle, finish them before closing.
+  // on a lost device they complete with an error.
+  for (auto control : _submitted)
+    usb_done(control);
+  _submitted.clear();
+  _connection++;
+
+  // transfers that write_wait() took are waited there without the port lock
+  std::unique_lock<std::mutex> wait_lock(_wait_mutex);
+  _wait_cv.wait(wait_lock, [this] { return _waiting == 0; });
+  wait_lock.unlock();
+
+  usb_close();
+}
+
+bool FT232::flush(void)
+{
+  if (_batch.empty())
+    return _connected;
+
+  bool ok = false;
+  if (_connected)
+  {
+    FT232GPIO_SPAN("FT232::usb_write");
+    emitted(_batch.data(), _batch.size());
+    auto f = usb_write(_batch.data(), _batch.size());
+    if (f < 0)
+    {
+      FT232GPIO_ERROR("write_data failed: %s", usb_error());
+      lost();
+    }
+    else
+      ok = true;
+  }
+  _batch.clear();
+  return ok;
+}
+
+void FT232::emitted(const uint8_t *buf, size_t size)
+{
+  _stats.transfers++;
+  _stats.bytes += size;
+  if (_tap)
+    _tap->record(buf, size, sample_rate());
+}
+
+void FT232::lost(void)
+{
+  // called with _lock held
+  if (not _connected)
+    return;
+
+  FT232GPIO_WARN("FT232 device lost, reconnecting");
+  _connected = false;
+  close();
+
+  // reconnect thread may fail again while replaying, it keeps trying
+  if (_reconnecting)
+    return;
+
+  if (_reconnect_thread.joinable())
+    _reconnect_thread.join(); // previous one has finished
+  _reconnecting = true;
+  _reconnect_thread = std::thread(&FT232::reconnect, this);
+}
+
+void FT232::reconnect(void)
+{
+  uint32_t backoff = RECONNECT_DELAY_MIN;
+
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(_reconnect_mutex);
+      if (_reconnect_cv.wait_for(lock, std::chrono::milliseconds(backoff),
+                                 [this] { return _reconnect_stop; }))
+        break;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    if (open())
+    {
+      _connected = true;
+      FT232GPIO_INFO("FT232 device reconnected");
+
+      // drivers send their last known state in one transfer
+      if (replay())
+      {
+        _reconnecting = false;
+        return;
+      }
+    }
+
+    backoff = backoff * 2 > RECONNECT_DELAY_MAX ? RECONNECT_DELAY_MAX : backoff * 2;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(_lock);
+  _reconnecting = false;
+}
+
+//
+// USB access through libftdi
+//
+
+bool FT232::usb_init(void)
+{
+  if ((_ftdi = ::ftdi_new()) == 0)
+  {
+    FT232GPIO_ERROR("ftdi_new failed");
+    return false;
+  }
+  return true;
+}
+
+void FT232::usb_deinit(void)
+{
+  ::ftdi_free(_ftdi);
+  _ftdi = nullptr;
+}
+
+bool FT232::usb_open(void)
+{
+  int fd_usb = ::ftdi_usb_open(_ftdi, FT232_VID, FT232_PID);
+  if (fd_usb < 0 && fd_usb != -5)
+  {
+    auto msg = ::ftdi_get_error_string(_ftdi);
+    FT232GPIO_ERROR("Unable to open ftdi device: %d (%s)", fd_usb, msg);
+    return false;
+  }
+  return true;
+}
+
+void FT232::usb_close(void)
+{
+  //
+  ::ftdi_usb_close(_ftdi);
+}
+
+bool FT232::usb_mode(uint8_t outputs, uint8_t mode)
+{
+  //
+  return ::ftdi_set_bitmode(_ftdi, outputs, mode) == 0;
+}
+
+bool FT232::usb_baudrate(uint32_t baudrate)
+{
+  //
+  return ::ftdi_set_baudrate(_ftdi, baudrate) == 0;
+}
+
+int FT232::usb_write(const uint8_t *buf, int size)
+{
+  //
+  return ::ftdi_write_data(_ftdi, buf, size);
+}
+
+struct ftdi_transfer_control *FT232::usb_submit(uint8_t *buf, int size)
+{
+  //
+  return ::ftdi_write_data_submit(_ftdi, buf, size);
+}
+
+int FT232::usb_done(struct ftdi_transfer_control *control)
+{
+  //
+  return ::ftdi_transfer_data_done(control);
+}
+
+int FT232::usb_read(uint8_t *buf, int size)
+{
+  //
+  return ::ftdi_read_data(_ftdi, buf, size);
+}
+
+bool FT232::usb_purge(void)
+{
+  //
+  return ::ftdi_usb_purge_rx_buffer(_ftdi) == 0;
+}
+
+int FT232::usb_pins(uint8_t *pins)
+{
+  //
+  return ::ftdi_read_pins(_ftdi, pins);
+}
+
+const char *FT232::usb_error(void)
+{
+  //
+  return ::ftdi_get_error_string(_ftdi);
+}
+
+std::string FT232::usb_serial(void)
+{
+  // from the device descriptor with the handle libftdi has open, reading
+  // strings through libftdi may reopen the device
+  struct libusb_device_descriptor desc;
+  if (::libusb_get_device_descriptor(::libusb_get_device(_ftdi->usb_dev), &desc) < 0)
+    return "";
+  if (desc.iSerialNumber == 0)
+    return "";
+
+  unsigned char serial[64];
+  int len = ::libusb_get_string_descriptor_ascii(_ftdi->usb_dev, desc.iSerialNumber, serial,
+                                                 sizeof(serial));
+  if (len <= 0)
+    return "";
+  return std::string(reinterpret_cast<char *>(serial), len);
+}
+
 } // namespace ft232gpio
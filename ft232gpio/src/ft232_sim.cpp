@@ -0,0 +1,115 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/ft232_sim.h"
+
+namespace ft232gpio
+{
+
+FT232Sim::~FT232Sim()
+{
+  // before FT232 is destroyed, so release() closes the simulated adapter
+  release();
+}
+
+uint64_t FT232Sim::bus_usecs(void) const
+{
+  //
+  return stats().bytes * 1000000 / sample_rate();
+}
+
+bool FT232Sim::usb_mode(uint8_t outputs, uint8_t mode)
+{
+  if (_unplugged)
+    return false;
+  _mode = mode;
+  return true;
+}
+
+int FT232Sim::usb_write(const uint8_t *buf, int size)
+{
+  if (_unplugged)
+    return -1;
+
+  if (_sink)
+    _sink(buf, size);
+
+  // synchronous bitbang samples the pins before each sample goes out, which
+  // includes what devices pull low after the sample before
+  if (_mode == BITMODE_SYNCBB)
+  {
+    for (int i = 0; i < size; ++i)
+    {
+      _rx.push_back(read_pins(_last));
+      _last = buf[i];
+      for (auto device : _devices)
+        device->feed(buf + i, 1, sample_rate());
+    }
+    return size;
+  }
+
+  if (size > 0)
+    _last = buf[size - 1];
+  for (auto device : _devices)
+    device->feed(buf, size, sample_rate());
+  return size;
+}
+
+struct ftdi_transfer_control *FT232Sim::usb_submit(uint8_t *buf, int size)
+{
+  if (usb_write(buf, size) < 0)
+    return nullptr;
+  return reinterpret_cast<struct ftdi_transfer_control *>(&_token);
+}
+
+int FT232Sim::usb_read(uint8_t *buf, int size)
+{
+  if (_unplugged)
+    return -1;
+
+  int count = 0;
+  while (count < size && not _rx.empty())
+  {
+    buf[count++] = _rx.front();
+    _rx.pop_front();
+  }
+  return count;
+}
+
+bool FT232Sim::usb_purge(void)
+{
+  _rx.clear();
+  return not _unplugged;
+}
+
+int FT232Sim::usb_pins(uint8_t *pins)
+{
+  if (_unplugged)
+    return -1;
+  *pins = read_pins(_last);
+  return 0;
+}
+
+uint8_t FT232Sim::read_pins(uint8_t sample) const
+{
+  uint8_t pins = _respond ? _respond(sample) : sample;
+  for (auto device : _devices)
+    pins &= ~device->pulls();
+  return pins;
+}
+
+} // namespace ft232gpio
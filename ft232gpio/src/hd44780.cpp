@@ -0,0 +1,640 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ft232gpio/hd44780.h"
+#include "ft232gpio/profile.h"
+#include "ft232gpio/span.h"
+
+#include <cassert>
+#include <cstring>
+#include <thread>
+
+// blanks between the end and the start of a rewritten marquee
+#define MARQUEE_GAP 4
+
+namespace ft232gpio
+{
+
+HD44780::HD44780()
+{
+  //
+  memset(_ddram, ' ', sizeof(_ddram));
+}
+
+HD44780::HD44780(const LCDGeometry &geometry) : _geometry(geometry)
+{
+  //
+  memset(_ddram, ' ', sizeof(_ddram));
+}
+
+static uint32_t usecs_since(std::chrono::steady_clock::time_point start)
+{
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+bool HD44780::begin(void)
+{
+  FT232GPIO_SPAN("HD44780::begin");
+
+  auto start = std::chrono::steady_clock::now();
+
+  _replay.add(ft232(), [this] { replay(); });
+
+  FT232Batch batch(ft232());
+
+  _display = true;
+  _cursor = true;
+  _blink = true;
+
+  // turn on back-light
+  _back_light = true;
+
+  init_4bit(4500, 150);
+  wait(200);
+
+  function_set(HD44780_LCD_FUNCSET_4BIT | HD44780_LCD_FUNCSET_2LINES | HD44780_LCD_FUNCSET_5x8);
+  wait(200);
+
+  cursor_set(HD44780_LCD_CURSOR_SHIFT_CUR | HD44780_LCD_CURSOR_RIGHT);
+  wait(200);
+
+  display_set();
+  wait(200);
+
+  entrymode_set(HD44780_LCD_ENTRY_INC);
+  wait(200);
+
+  _initalized = true;
+
+  clear();
+  wait(100);
+
+  bool ok = batch.end();
+  _init_usecs = usecs_since(start);
+
+  return ok;
+}
+
+bool HD44780::resume(bool cursor, bool blink)
+{
+  FT232GPIO_SPAN("HD44780::resume");
+
+  auto start = std::chrono::steady_clock::now();
+
+  _replay.add(ft232(), [this] { replay(); });
+
+  FT232Batch batch(ft232());
+
+  _display = true;
+  _cursor = cursor;
+  _blink = blink;
+  _back_light = true;
+
+  // controller is running, so only command execution times apply. the first
+  // nibble may complete a half sent instruction, worst is return home.
+  init_4bit(1600, 50);
+
+  function_set(HD44780_LCD_FUNCSET_4BIT | HD44780_LCD_FUNCSET_2LINES | HD44780_LCD_FUNCSET_5x8);
+  wait(50);
+
+  display_set();
+  wait(50);
+
+  entrymode_set(HD44780_LCD_ENTRY_INC);
+  wait(50);
+
+  _page_front = 0;
+  _initalized = true;
+
+  bool ok = batch.end();
+  _init_usecs = usecs_since(start);
+
+  return ok;
+}
+
+void HD44780::end(void)
+{
+  _replay.remove();
+  FT232Batch batch(ft232());
+
+  _back_light = false;
+  _display = false;
+  _cursor = false;
+  _blink = false;
+  display_set();
+  clear();
+
+  _initalized = false;
+}
+
+void HD44780::clear()
+{
+  FT232GPIO_SPAN("HD44780::clear");
+
+  FT232Batch batch(ft232());
+
+  uint8_t cmd = HD44780_LCD_CMD_CLEAR;
+  send_ctrl(cmd);
+  wait(_timing.clear_usecs);
+
+  _page_front = 0; // clear also resets display shift
+}
+
+void HD44780::home()
+{
+  FT232GPIO_SPAN("HD44780::home");
+
+  FT232Batch batch(ft232());
+
+  uint8_t cmd = HD44780_LCD_CMD_RETHOME;
+  send_ctrl(cmd);
+  wait(_timing.home_usecs);
+
+  _page_front = 0;
+}
+
+void HD44780::display(bool enable)
+{
+  FT232GPIO_SPAN("HD44780::display");
+
+  FT232Batch batch(ft232());
+
+  _display = enable;
+  display_set();
+  wait(_timing.cmd_usecs);
+}
+
+void HD44780::cursor(bool enable)
+{
+  FT232GPIO_SPAN("HD44780::cursor");
+
+  FT232Batch batch(ft232());
+
+  _cursor = enable;
+  display_set();
+  wait(_timing.cmd_usecs);
+}
+
+void HD44780::blink(bool enable)
+{
+  FT232GPIO_SPAN("HD44780::blink");
+
+  FT232Batch batch(ft232());
+
+  _blink = enable;
+  display_set();
+  wait(_timing.cmd_usecs);
+}
+
+void HD44780::putc(const char c)
+{
+  send_data(c);
+  wait(_timing.cmd_usecs);
+}
+
+void HD44780::puts(const char *str)
+{
+  FT232GPIO_SPAN("HD44780::puts");
+
+  FT232Batch batch(ft232());
+
+  while (*str != '\x0')
+  {
+    putc(*str++);
+  }
+}
+
+void HD44780::putch(uint8_t ch)
+{
+  FT232GPIO_SPAN("HD44780::putch");
+
+  FT232Batch batch(ft232());
+
+  send_data(ch);
+  wait(_timing.cmd_usecs);
+}
+
+void HD44780::move(uint8_t row, uint8_t col)
+{
+  FT232GPIO_SPAN("HD44780::move");
+
+  FT232Batch batch(ft232());
+
+  uint8_t cmd = HD44780_LCD_CMD_DDRAMADDR;
+
+  // row 0 : 0x00 ~ 0x27, row 2 continues row 0 from 0x00 + cols
+  // row 1 : 0x40 ~ 0x67, row 3 continues row 1 from 0x40 + cols
+  // rows and columns out of range are clamped by the geometry tables
+  if (_double_buffer && col < _geometry.cols)
+    col += _page_front ? 0 : _geometry.cols; // draw to the hidden page
+
+  send_ctrl(cmd | _geometry.addr(row, col));
+  wait(_timing.cmd_usecs);
+}
+
+void HD44780::cgram(uint8_t ch, uint8_t *data, uint32_t leng)
+{
+  FT232GPIO_SPAN("HD44780::cgram");
+
+  FT232Batch batch(ft232());
+
+  uint8_t cmd = HD44780_LCD_CMD_CGRAMADDR;
+  // NOTE CGRAM address is mapped as 8 bytes per character
+  // << 3 (== *8) to jump to address of ch
+  cmd |= (ch << 3) & 0x3f;
+  send_ctrl(cmd);
+  wait(_timing.cmd_usecs);
+
+  for (size_t p = 0; p < leng; ++p)
+  {
+    send_data(data[p]);
+    wait(_timing.cmd_usecs);
+  }
+}
+
+void HD44780::marquee(uint8_t row, const char *text, uint32_t interval_ms, bool shift)
+{
+  FT232Batch batch(ft232());
+
+  double_buffer(false);
+
+  _marquee_text = text;
+  _marquee_row = row;
+  _marquee_pos = 0;
+  _marquee_interval = std::chrono::milliseconds(interval_ms);
+  _marquee_next = std::chrono::steady_clock::now() + _marquee_interval;
+
+  // display shift scrolls a whole 40 column DDRAM line as a ring, which is
+  // row 0 + row 2 or row 1 + row 3 on 4 row panels
+  _marquee_shift = shift && _marquee_text.size() <= LCD_DDRAM_LINE_COLS && _geometry.rows <= 2;
+  if (not _marquee_shift)
+  {
+    marquee_window();
+    return;
+  }
+
+  // start from no shift and fill the whole line once, blanks clear old text
+  home();
+  move(_marquee_row, 0);
+  for (uint32_t c = 0; c < LCD_DDRAM_LINE_COLS; ++c)
+    putc(c < _marquee_text.size() ? _marquee_text[c] : ' ');
+}
+
+bool HD44780::marquee_tick(void)
+{
+  if (_marquee_text.empty())
+    return false;
+
+  auto now = std::chrono::steady_clock::now();
+  if (now < _marquee_next)
+    return false;
+
+  marquee_step();
+
+  // keep the rate, but do not try to catch up steps we were late for
+  _marquee_next += _marquee_interval;
+  if (_marquee_next < now)
+    _marquee_next = now + _marquee_interval;
+  return true;
+}
+
+void HD44780::marquee_step(void)
+{
+  FT232GPIO_SPAN("HD44780::marquee_step");
+
+  FT232Batch batch(ft232());
+
+  if (_marquee_text.empty())
+    return;
+
+  if (_marquee_shift)
+  {
+    _marquee_pos = (_marquee_pos + 1) % LCD_DDRAM_LINE_COLS;
+    cursor_set(HD44780_LCD_CURSOR_SHIFT_DIS | HD44780_LCD_CURSOR_LEFT);
+    wait(_timing.cmd_usecs);
+    return;
+  }
+
+  _marquee_pos = (_marquee_pos + 1) % (_marquee_text.size() + MARQUEE_GAP);
+  marquee_window();
+}
+
+void HD44780::marquee_run(uint32_t steps)
+{
+  _marquee_next = std::chrono::steady_clock::now();
+  for (uint32_t s = 0; s < steps; ++s)
+  {
+    _marquee_next += _marquee_interval;
+    std::this_thread::sleep_until(_marquee_next);
+    marquee_step();
+  }
+}
+
+void HD44780::marquee_stop(void)
+{
+  FT232Batch batch(ft232());
+
+  if (_marquee_shift && _marquee_pos != 0)
+    home(); // undo display shift
+
+  _marquee_text.clear();
+  _marquee_pos = 0;
+}
+
+bool HD44780::double_buffer(bool enable)
+{
+  FT232Batch batch(ft232());
+
+  if (enable == _double_buffer)
+    return true;
+
+  if (enable)
+  {
+    // two pages must fit in a 40 column DDRAM line that holds only one row
+    if (_geometry.rows > 2 || _geometry.cols * 2 > LCD_DDRAM_LINE_COLS)
+      return false;
+    // slow transports would show the flip as a scroll
+    if (not fast_commands())
+      return false;
+    marquee_stop();
+  }
+
+  _double_buffer = enable;
+  if (_page_front != 0)
+    home();
+  return batch.end();
+}
+
+void HD44780::page_flip(void)
+{
+  FT232GPIO_SPAN("HD44780::page_flip");
+
+  FT232Batch batch(ft232());
+
+  if (not _double_buffer)
+    return;
+
+  if (_page_front)
+  {
+    // back to column 0 with a single command
+    home();
+    return;
+  }
+
+  // shift the window to column cols, all commands in one I2C transaction
+  uint8_t cmds[LCD_DDRAM_LINE_COLS / 2];
+  for (uint8_t c = 0; c < _geometry.cols; ++c)
+    cmds[c] = HD44780_LCD_CMD_CURSOR | HD44780_LCD_CURSOR_SHIFT_DIS | HD44780_LCD_CURSOR_LEFT;
+  send_ctrls(cmds, _geometry.cols);
+  wait(_timing.cmd_usecs);
+
+  _page_front = 1;
+}
+
+void HD44780::marquee_window(void)
+{
+  const uint32_t period = _marquee_text.size() + MARQUEE_GAP;
+
+  move(_marquee_row, 0);
+  for (uint32_t c = 0; c < _geometry.cols; ++c)
+  {
+    uint32_t idx = (_marquee_pos + c) % period;
+    putc(idx < _marquee_text.size() ? _marquee_text[idx] : ' ');
+  }
+}
+
+void HD44780::init_4bit(uint32_t delay_first, uint32_t delay)
+{
+  uint8_t data;
+
+  // send RS=0, RW=0, DB7~DB4=0011 as 8bit 3 times
+  data = HD44780_LCD_CMD_FUNCSET | HD44780_LCD_FUNCSET_8BIT;
+  write_4bits(data >> 4, false, delay_first);
+  write_4bits(data >> 4, false, delay);
+  write_4bits(data >> 4, false, delay);
+
+  // send RS=0, RW=0, DB7~DB4=0010 as 4bit 1 time
+  data = HD44780_LCD_CMD_FUNCSET;
+  write_4bits(data >> 4, false, delay);
+}
+
+void HD44780::send_data(uint8_t data)
+{
+  track_data(data);
+
+  // RS high is to select DATA, bit 7~4 and then bit 3~0
+  write_4bits(data >> 4, true, _timing.nibble_usecs);
+  write_4bits(data & 0x0f, true, _timing.nibble_usecs);
+}
+
+void HD44780::send_ctrl(uint8_t data)
+{
+  track_ctrl(data);
+
+  // TODO support send data with 8bits
+
+  // RS low is to select CONTROL
+  write_4bits(data >> 4, false, _timing.nibble_usecs);
+  write_4bits(data & 0x0f, false, _timing.nibble_usecs);
+}
+
+void HD44780::send_ctrls(const uint8_t *data, uint32_t count)
+{
+  //
+  send_run(data, count, false);
+}
+
+void HD44780::send_run(const uint8_t *data, uint32_t count, bool rs)
+{
+  if (count == 0)
+    return;
+
+  write_run(data, count, rs);
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    if (rs)
+      track_data(data[i]);
+    else
+      track_ctrl(data[i]);
+  }
+}
+
+void HD44780::wait(uint32_t usecs)
+{
+  //
+  ft232()->delay(usecs);
+}
+
+void HD44780::load_timing(uint32_t addr)
+{
+  _timing = LCD_TIMING_DEFAULT;
+  timing_profiles().lookup(ft232()->serial(), addr, _timing);
+}
+
+void HD44780::track_ctrl(uint8_t cmd)
+{
+  // follow what the command does to DDRAM address, CGRAM and display shift
+  if (cmd & HD44780_LCD_CMD_DDRAMADDR)
+  {
+    _ac = cmd & 0x7f;
+    _ac_cgram = false;
+  }
+  else if (cmd & HD44780_LCD_CMD_CGRAMADDR)
+  {
+    _ac = cmd & 0x3f;
+    _ac_cgram = true;
+  }
+  else if (cmd & HD44780_LCD_CMD_FUNCSET)
+  {
+    // nothing to follow
+  }
+  else if (cmd & HD44780_LCD_CMD_CURSOR)
+  {
+    bool right = (cmd & HD44780_LCD_CURSOR_RIGHT) != 0;
+    if (cmd & HD44780_LCD_CURSOR_SHIFT_DIS)
+      _shift = (_shift + (right ? LCD_DDRAM_LINE_COLS - 1 : 1)) % LCD_DDRAM_LINE_COLS;
+    else if (right)
+      _ac = ddram_next(_ac);
+  }
+  else if (cmd & (HD44780_LCD_CMD_DISPLAY | HD44780_LCD_CMD_ENTRY))
+  {
+    // flags are kept in members, entry mode is always increment
+  }
+  else if (cmd & (HD44780_LCD_CMD_RETHOME | HD44780_LCD_CMD_CLEAR))
+  {
+    if (cmd == HD44780_LCD_CMD_CLEAR)
+      memset(_ddram, ' ', sizeof(_ddram));
+    _ac = 0;
+    _ac_cgram = false;
+    _shift = 0;
+  }
+}
+
+void HD44780::track_data(uint8_t data)
+{
+  if (_ac_cgram)
+  {
+    _cgram[_ac] = data;
+    _cgram_used |= 1 << (_ac >> 3);
+    _ac = (_ac + 1) & 0x3f;
+    return;
+  }
+
+  uint8_t col = _ac & 0x3f;
+  if (col < LCD_DDRAM_LINE_COLS)
+    _ddram[_ac >> 6 & 0x01][col] = data;
+  _ac = ddram_next(_ac);
+}
+
+uint8_t HD44780::ddram_next(uint8_t ac)
+{
+  // end of a line continues to the start of the other line
+  uint8_t col = (ac & 0x3f) + 1;
+  if (col < LCD_DDRAM_LINE_COLS)
+    return (ac & LCD_DDRAM_LINE1) | col;
+  return (ac & LCD_DDRAM_LINE1) ^ LCD_DDRAM_LINE1;
+}
+
+void HD44780::replay(void)
+{
+  // keep these as sending below also updates them
+  const uint8_t ac = _ac;
+  const bool ac_cgram = _ac_cgram;
+  const uint8_t shift = _shift;
+  uint8_t ddram[2][LCD_DDRAM_LINE_COLS];
+  memcpy(ddram, _ddram, sizeof(ddram));
+
+  // adapter reset may have power cycled the panel, so start from reset
+  init_4bit(4500, 150);
+  function_set(HD44780_LCD_FUNCSET_4BIT | HD44780_LCD_FUNCSET_2LINES | HD44780_LCD_FUNCSET_5x8);
+  wait(50);
+  display_set();
+  wait(50);
+  entrymode_set(HD44780_LCD_ENTRY_INC);
+  wait(50);
+  send_ctrl(HD44780_LCD_CMD_CLEAR);
+  wait(5000);
+
+  for (uint8_t ch = 0; ch < 8; ++ch)
+  {
+    if (_cgram_used & (1 << ch))
+    {
+      send_ctrl(HD44780_LCD_CMD_CGRAMADDR | (ch << 3));
+      send_run(_cgram + (ch << 3), 8, true);
+    }
+  }
+
+  // only the text, clear has filled the rest with blanks
+  for (uint8_t line = 0; line < 2; ++line)
+  {
+    uint8_t col = 0;
+    while (col < LCD_DDRAM_LINE_COLS)
+    {
+      if (ddram[line][col] == ' ')
+      {
+        col++;
+        continue;
+      }
+      uint8_t begin = col;
+      while (col < LCD_DDRAM_LINE_COLS && ddram[line][col] != ' ')
+        col++;
+      send_ctrl(HD44780_LCD_CMD_DDRAMADDR | (line ? LCD_DDRAM_LINE1 : 0) | begin);
+      send_run(&ddram[line][begin], col - begin, true);
+    }
+  }
+
+  uint8_t cmds[LCD_DDRAM_LINE_COLS];
+  for (uint8_t c = 0; c < shift; ++c)
+    cmds[c] = HD44780_LCD_CMD_CURSOR | HD44780_LCD_CURSOR_SHIFT_DIS | HD44780_LCD_CURSOR_LEFT;
+  send_ctrls(cmds, shift);
+
+  send_ctrl((ac_cgram ? HD44780_LCD_CMD_CGRAMADDR : HD44780_LCD_CMD_DDRAMADDR) | ac);
+  wait(50);
+}
+
+void HD44780::function_set(uint8_t data)
+{
+  uint8_t cmd = HD44780_LCD_CMD_FUNCSET;
+  cmd |= data;
+  send_ctrl(cmd);
+}
+
+void HD44780::cursor_set(uint8_t data)
+{
+  uint8_t cmd = HD44780_LCD_CMD_CURSOR;
+  cmd |= data;
+  send_ctrl(cmd);
+}
+
+void HD44780::display_set(void)
+{
+  uint8_t cmd = HD44780_LCD_CMD_DISPLAY;
+  cmd |= _display ? HD44780_LCD_DISPLAY_ON : 0;
+  cmd |= _cursor ? HD44780_LCD_DISPLAY_CUR : 0;
+  cmd |= _blink ? HD44780_LCD_DISPLAY_BLINK : 0;
+  send_ctrl(cmd);
+}
+
+void HD44780::entrymode_set(uint8_t data)
+{
+  uint8_t cmd = HD44780_LCD_CMD_ENTRY;
+  cmd |= data;
+  send_ctrl(cmd);
+}
+
+} // namespace ft232gpio
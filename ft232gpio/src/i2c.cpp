@@ -17,17 +17,14 @@
 // Reference code from https://en.wikipedia.org/wiki/I%C2%B2C
 
 #include "ft232gpio/i2c.h"
+#include "ft232gpio/log.h"
+#include "ft232gpio/profile.h"
+#include "ft232gpio/span.h"
 
 #include <cassert>
-#include <iostream>
 #include <stdexcept>
+#include <vector>
 
-#include <unistd.h> // usleep
-
-#define PIN_SCL 0x08 // CTS of FT232
-#define PIN_SDA 0x10 // DTR of FT232
-
-#define I2C_DELAY 10
 #define I2C_DELAY_WAIT 1
 #define I2C_RETRY 1000
 
@@ -46,17 +43,29 @@ I2C::~I2C()
   //
 }
 
+void I2C::pins(uint8_t scl, uint8_t sda)
+{
+  assert(not _initalized);
+  _pin_scl = scl;
+  _pin_sda = sda;
+}
+
 bool I2C::init(FT232 *ft232, uint8_t addr)
 {
   _ft232 = ft232;
   _addr = addr;
 
+  _timing = I2C_TIMING_DEFAULT;
+  timing_profiles().lookup(_ft232->serial(), _addr, _timing);
+
   _lost = false;
   _started = false;
 
   _set_sda();
   _set_scl();
-  _ft232_data = PIN_SCL | PIN_SDA;
+  _ft232_data = _pin_scl | _pin_sda;
+
+  _replay_entry.add(_ft232, [this] { _replay(); });
 
   _initalized = true;
 
@@ -70,9 +79,11 @@ void I2C::release(void)
     assert(false);
     return;
   }
+  _replay_entry.remove();
+
   _set_sda();
   _set_scl();
-  _ft232_data = PIN_SCL | PIN_SDA;
+  _ft232_data = _pin_scl | _pin_sda;
 
   _addr = 0;
   _ft232 = nullptr;
@@ -81,39 +92,39 @@ void I2C::release(void)
 
 void I2C::_set_sda(void)
 {
-  _ft232_data |= PIN_SDA;
-  _ft232->write_data(&_ft232_data, 1);
+  _ft232_data |= _pin_sda;
+  _write_pins();
 }
 
 void I2C::_set_scl(void)
 {
-  _ft232_data |= PIN_SCL;
-  _ft232->write_data(&_ft232_data, 1);
+  _ft232_data |= _pin_scl;
+  _write_pins();
 }
 
 void I2C::_clear_sda(void)
 {
-  _ft232_data &= ~PIN_SDA;
-  _ft232->write_data(&_ft232_data, 1);
+  _ft232_data &= ~_pin_sda;
+  _write_pins();
 }
 
 void I2C::_clear_scl(void)
 {
-  _ft232_data &= ~PIN_SCL;
-  _ft232->write_data(&_ft232_data, 1);
+  _ft232_data &= ~_pin_scl;
+  _write_pins();
 }
 
 uint8_t I2C::_read_scl(void)
 {
 #if IGNORE_READ
   _delay();
-  return PIN_SCL;
+  return _pin_scl;
 #else
   uint8_t data;
   if (!_ft232->read_data(&data))
     return 0;
   // printf("Read SCL: 0x%02x\r\n", (uint32_t)data);
-  return data & PIN_SCL;
+  return data & _pin_scl;
 #endif
 }
 
@@ -121,13 +132,13 @@ uint8_t I2C::_read_sda(void)
 {
 #if IGNORE_READ
   _delay();
-  return PIN_SDA;
+  return _pin_sda;
 #else
   uint8_t data;
   if (!_ft232->read_data(&data))
     return 0;
   // printf("Read SDA: 0x%02x\r\n", (uint32_t)data);
-  return data & PIN_SDA;
+  return data & _pin_sda;
 #endif
 }
 
@@ -143,10 +154,30 @@ void I2C::_dummy_clock(void)
 void I2C::_delay(void)
 {
   //
-  usleep(I2C_DELAY);
+  _ft232->delay(_timing.clock_usecs);
+}
+
+void I2C::_delay_setup(void)
+{
+  //
+  _ft232->delay(_timing.setup_usecs);
+}
+
+void I2C::_replay(void)
+{
+  // device came back, bus starts idle with both lines high
+  _ft232_data = _pin_scl | _pin_sda;
+  _write_pins();
+  _started = false;
+}
+
+void I2C::_write_pins(void)
+{
+  //
+  _ft232->write_pins(pin_mask(), _ft232_data);
 }
 
-void I2C::_arbitration_lost(void) { std::cerr << "I2C arbitration_lost" << std::endl; }
+void I2C::_arbitration_lost(void) { FT232GPIO_WARN("I2C arbitration_lost"); }
 
 void I2C::_wait_scl(void)
 {
@@ -155,11 +186,11 @@ void I2C::_wait_scl(void)
   {
     if (!retry)
     {
-      std::cerr << "I2C wait SCL timeout" << std::endl;
+      FT232GPIO_WARN("I2C wait SCL timeout");
       break;
     }
     retry--;
-    usleep(I2C_DELAY_WAIT);
+    _ft232->delay(I2C_DELAY_WAIT);
   }
 }
 
@@ -210,7 +241,7 @@ void I2C::write_bit(bool bit)
   else
     _clear_sda();
 
-  _delay();
+  _delay_setup();
   _set_scl();
   _delay();
   //_wait_scl();
@@ -224,7 +255,7 @@ bool I2C::read_bit(void)
   bool bit;
 
   _set_sda();
-  _delay();
+  _delay_setup();
   _set_scl();
 
   _wait_scl();
@@ -239,34 +270,20 @@ bool I2C::read_bit(void)
 
 bool I2C::write_byte(bool send_start, bool send_stop, uint8_t data)
 {
+  FT232GPIO_SPAN("I2C::write_byte");
+
   uint32_t bit;
   uint8_t send;
   bool nack;
 
+  FT232Batch batch(_ft232);
+
   if (send_start)
   {
     start_cond();
     _delay();
 
-    // send 7bit addr, from MSB to LSB
-    send = _addr;
-    send <<= 1;
-    for (bit = 0; bit < 7; ++bit)
-    {
-      bool set = (send & 0x80) != 0;
-      // std::cout << set ? "1" : "0";
-      write_bit(set);
-      send <<= 1;
-    }
-    // std::cout << "W";
-    //  send W (0)
-    write_bit(0);
-
-    // read ack
-    nack = read_bit() ? true : false;
-    // std::cout << "Addres ACK: " << (nack ? 1 : 0) << std::endl;
-    // std::cout << " ACK" << (nack ? 1 : 0);
-    // std::cout << std::endl;
+    nack = _send_address(false);
   }
 
   // send data
@@ -287,15 +304,68 @@ bool I2C::write_byte(bool send_start, bool send_stop, uint8_t data)
   if (send_stop)
     stop_cond();
 
-  return nack;
+  // a failed transfer is not acknowledged either
+  return batch.end() ? nack : true;
+}
+
+bool I2C::_read_bits(int32_t count, uint32_t &bits)
+{
+  // clocks with SDA released, the sample taken with each falling SCL shows
+  // SDA at the end of SCL high. MSB first.
+  _set_sda();
+  const uint32_t setup = _ft232->samples(_timing.setup_usecs);
+  const uint32_t hold = _ft232->samples(_timing.clock_usecs);
+  const uint8_t base = (_ft232->port() & ~pin_mask()) | _pin_sda;
+  std::vector<uint8_t> out;
+  std::vector<uint32_t> reads;
+  for (int32_t b = 0; b < count; ++b)
+  {
+    out.insert(out.end(), setup, base);
+    out.insert(out.end(), hold, base | _pin_scl);
+    reads.push_back(out.size());
+  }
+  out.push_back(base);
+  std::vector<uint8_t> in(out.size());
+  bool ok = _ft232->transfer(out.data(), in.data(), out.size(), 0xFF & ~_pin_sda);
+  _ft232_data = _pin_sda;
+
+  bits = 0;
+  for (auto r : reads)
+    bits = (bits << 1) | (in[r] & _pin_sda ? 1 : 0);
+  return ok;
+}
+
+bool I2C::_send_address(bool read)
+{
+  uint32_t bit;
+  uint8_t send;
+
+  // send 7bit addr, from MSB to LSB
+  send = _addr;
+  send <<= 1;
+  for (bit = 0; bit < 7; ++bit)
+  {
+    bool set = (send & 0x80) != 0;
+    write_bit(set);
+    send <<= 1;
+  }
+  // send R (1) or W (0)
+  write_bit(read);
+
+  // read ack
+  return read_bit() ? true : false;
 }
 
 // Read a byte from I2C bus
 uint8_t I2C::read_byte(bool nack, bool send_stop)
 {
+  FT232GPIO_SPAN("I2C::read_byte");
+
   uint8_t byte = 0;
   uint8_t bit;
 
+  FT232Batch batch(_ft232);
+
   for (bit = 0; bit < 8; ++bit)
   {
     byte = (byte << 1) | (read_bit() ? 0x01 : 0x00);
@@ -309,4 +379,78 @@ uint8_t I2C::read_byte(bool nack, bool send_stop)
   return byte;
 }
 
+bool I2C::probe(void)
+{
+  FT232GPIO_SPAN("I2C::probe");
+
+  FT232Batch batch(_ft232);
+
+  start_cond();
+  _delay();
+
+  uint8_t send = _addr << 1; // write
+  for (uint32_t bit = 0; bit < 8; ++bit)
+  {
+    write_bit((send & 0x80) != 0);
+    send <<= 1;
+  }
+
+  // acknowledge clock with SDA as input, the sample taken with the falling
+  // SCL shows SDA at the end of SCL high
+  _set_sda();
+  _delay_setup();
+  const uint32_t hold = _ft232->samples(_timing.clock_usecs);
+  const uint8_t base = _ft232->port() & ~pin_mask();
+  std::vector<uint8_t> out(hold, base | _pin_sda | _pin_scl);
+  out.push_back(base | _pin_sda);
+  std::vector<uint8_t> in(out.size());
+  bool ok = _ft232->transfer(out.data(), in.data(), out.size(), 0xFF & ~_pin_sda);
+  _ft232_data = _pin_sda;
+
+  // SDA low then high with SCL high, a real stop
+  _clear_sda();
+  _delay();
+  stop_cond();
+  ok = batch.end() && ok;
+
+  return ok && (in[hold] & _pin_sda) == 0;
+}
+
+bool I2C::read(uint8_t *data, int32_t length)
+{
+  FT232GPIO_SPAN("I2C::read");
+
+  FT232Batch batch(_ft232);
+
+  start_cond();
+  _delay();
+
+  uint8_t send = (_addr << 1) | 0x01; // read
+  for (uint32_t bit = 0; bit < 8; ++bit)
+  {
+    write_bit((send & 0x80) != 0);
+    send <<= 1;
+  }
+
+  // the acknowledge of the address comes with the first byte
+  uint32_t bits = 0;
+  bool ok = _read_bits(length > 0 ? 9 : 1, bits);
+  bool ack = ok && (bits >> (length > 0 ? 8 : 0) & 1) == 0;
+  for (int32_t i = 0; ack && i < length; ++i)
+  {
+    if (i > 0)
+      ok = ok && _read_bits(8, bits);
+    data[i] = bits & 0xFF;
+    // nack on the last byte, the device releases SDA for the stop
+    write_bit(i + 1 == length);
+  }
+
+  _clear_sda();
+  _delay();
+  stop_cond();
+  ok = batch.end() && ok;
+
+  return ok && ack;
+}
+
 } // namespace ft232gpio
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ft232gpio/input.h"
+#include "ft232gpio/log.h"
+
+#define INPUT_BLOCK 4096
+#define INPUT_FIRST_MSEC 100 // for the first samples in start()
+
+namespace ft232gpio
+{
+
+InputWatcher::~InputWatcher()
+{
+  //
+  stop();
+}
+
+bool InputWatcher::start(FT232 *ft232, uint8_t pins, uint32_t rate, uint32_t debounce_usecs)
+{
+  if (_running || pins == 0 || rate == 0)
+    return false;
+
+  _ft232 = ft232;
+  _pins = pins;
+  _decimate = _ft232->sample_rate() / rate;
+  _decimate = _decimate > 0 ? _decimate : 1;
+  _rate = _ft232->sample_rate() / _decimate;
+  debounce(0xff, debounce_usecs);
+  for (auto &count : _count)
+    count = 0;
+  _has_state = false;
+
+  _inputs = _ft232->inputs();
+  _ft232->inputs(_inputs | _pins);
+  _ft232->purge_samples();
+  _index = 0;
+  _start = std::chrono::steady_clock::now();
+
+  // first samples set the levels, so state() is valid when start() returns
+  uint8_t buf[INPUT_BLOCK];
+  for (int32_t ms = 0; ms < INPUT_FIRST_MSEC && not _has_state; ++ms)
+  {
+    int got = _ft232->read_samples(buf, INPUT_BLOCK);
+    if (got > 0)
+      feed(buf, got);
+    else
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (not _has_state)
+    FT232GPIO_WARN("InputWatcher no samples, state is not known yet");
+
+  _running = true;
+  _thread = std::thread(&InputWatcher::run, this);
+  return true;
+}
+
+void InputWatcher::stop(void)
+{
+  if (not _thread.joinable())
+    return;
+
+  _running = false;
+  _thread.join();
+  _ft232->inputs(_inputs);
+}
+
+void InputWatcher::debounce(uint8_t pins, uint32_t usecs)
+{
+  for (int32_t p = 0; p < 8; ++p)
+  {
+    if (pins & (1 << p))
+      _debounce[p] = usecs;
+  }
+}
+
+void InputWatcher::on_edge(std::function<void(const InputEvent &)> callback)
+{
+  std::lock_guard<std::mutex> lock(_callback_mutex);
+  _callback = std::move(callback);
+}
+
+//
+// InputWatcher privates
+//
+
+void InputWatcher::run(void)
+{
+  uint8_t buf[INPUT_BLOCK];
+
+  while (_running)
+  {
+    int got = _ft232->read_samples(buf, INPUT_BLOCK);
+    if (got <= 0)
+    {
+      // nothing yet, or reconnecting
+      std::this_thread::sleep_for(std::chrono::milliseconds(got < 0 ? 10 : 1));
+      continue;
+    }
+    feed(buf, got);
+  }
+}
+
+void InputWatcher::feed(const uint8_t *buf, int count)
+{
+  for (int i = 0; i < count; ++i, ++_index)
+  {
+    if (_index % _decimate == 0)
+      sample(buf[i] & _pins, _index / _decimate);
+  }
+}
+
+void InputWatcher::sample(uint8_t value, uint64_t index)
+{
+  if (not _has_state)
+  {
+    _state = value;
+    _candidate = value;
+    _has_state = true;
+    return;
+  }
+
+  uint8_t state = _state;
+  if (value == state && value == _candidate)
+    return; // nothing changing, the common case
+
+  // a pin that changes again restarts its count
+  uint8_t restart = value ^ _candidate;
+  _candidate = value;
+  for (int32_t p = 0; p < 8; ++p)
+  {
+    uint8_t bit = 1 << p;
+    if (not((value ^ state) & bit))
+      continue;
+    _count[p] = restart & bit ? 0 : _count[p] + 1;
+    if (uint64_t(_count[p]) * 1000000 >= uint64_t(_debounce[p]) * _rate)
+    {
+      // time of the first sample at the new level
+      state ^= bit;
+      emit(bit, value & bit, index - _count[p]);
+    }
+  }
+  _state = state;
+}
+
+void InputWatcher::emit(uint8_t pin, bool level, uint64_t index)
+{
+  FT232GPIO_DEBUG("Input 0x%02x %s", pin, level ? "rising" : "falling");
+
+  auto offset = std::chrono::nanoseconds(index * 1000000000ull / _rate);
+  InputEvent event{pin, level, _start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset)};
+
+  std::lock_guard<std::mutex> lock(_callback_mutex);
+  if (_callback)
+    _callback(event);
+  else
+    _queue.push(event);
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/lcd1602_parallel.h"
+#include "ft232gpio/log.h"
+
+namespace ft232gpio
+{
+
+void LCD1602Parallel::pins(uint8_t rs, uint8_t en, uint8_t d4, uint8_t d5, uint8_t d6,
+                           uint8_t d7, uint8_t bl)
+{
+  _pin_rs = rs;
+  _pin_en = en;
+  _pin_data[0] = d4;
+  _pin_data[1] = d5;
+  _pin_data[2] = d6;
+  _pin_data[3] = d7;
+  _pin_bl = bl;
+}
+
+uint8_t LCD1602Parallel::pin_mask(void) const
+{
+  return _pin_rs | _pin_en | _pin_data[0] | _pin_data[1] | _pin_data[2] | _pin_data[3] |
+         _pin_bl;
+}
+
+bool LCD1602Parallel::init(FT232 *ft232)
+{
+  FT232GPIO_DEBUG("LCD1602Parallel::init");
+
+  _ft232 = ft232;
+  load_timing(pin_mask());
+  return begin();
+}
+
+bool LCD1602Parallel::attach(FT232 *ft232, bool cursor, bool blink)
+{
+  _ft232 = ft232;
+  load_timing(pin_mask());
+  if (not resume(cursor, blink))
+    return false;
+
+  FT232GPIO_INFO("LCD1602Parallel::attach %uus", init_usecs());
+  return true;
+}
+
+void LCD1602Parallel::release(void)
+{
+  end();
+  _ft232 = nullptr;
+}
+
+void LCD1602Parallel::nibble_samples(uint8_t nibble, bool rs, uint8_t *samples) const
+{
+  uint8_t value = _ft232->port() & ~pin_mask();
+  for (int32_t b = 0; b < 4; ++b)
+    value |= (nibble >> b) & 1 ? _pin_data[b] : 0;
+  value |= rs ? _pin_rs : 0;
+  value |= _back_light ? _pin_bl : 0;
+
+  // RS and data settle before EN rises and are latched at the falling edge.
+  // a sample is a few usecs, longer than any of setup, pulse and hold time.
+  samples[0] = value;
+  samples[1] = value | _pin_en;
+  samples[2] = value;
+}
+
+void LCD1602Parallel::write_4bits(uint8_t nibble, bool rs, uint32_t delay)
+{
+  uint8_t samples[3];
+
+  nibble_samples(nibble, rs, samples);
+  _ft232->write_data(samples, sizeof(samples));
+  wait(delay);
+}
+
+void LCD1602Parallel::write_run(const uint8_t *data, uint32_t count, bool rs)
+{
+  // only the second nibble needs the command time, the first is just latched
+  uint8_t samples[6];
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    nibble_samples(data[i] >> 4, rs, samples);
+    nibble_samples(data[i] & 0x0f, rs, samples + 3);
+    _ft232->write_data(samples, sizeof(samples));
+    wait(timing().cmd_usecs);
+  }
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ft232gpio/log.h"
+#include "ft232gpio/ring.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#define LOG_RING_SIZE 1024
+#define LOG_TEXT_SIZE 116
+#define LOG_DRAIN_MSEC 10
+
+namespace ft232gpio
+{
+
+namespace
+{
+
+struct LogRecord
+{
+  int64_t usecs;
+  int32_t level;
+  char text[LOG_TEXT_SIZE];
+};
+
+const char _level_char[] = {'T', 'D', 'I', 'W', 'E'};
+
+class Logger
+{
+public:
+  Logger() : _start(std::chrono::steady_clock::now())
+  {
+    _thread = std::thread(&Logger::drain_loop, this);
+  }
+
+  ~Logger()
+  {
+    _stop = true;
+    _thread.join();
+    drain();
+  }
+
+public:
+  void write(int level, const char *fmt, va_list ap)
+  {
+    auto now = std::chrono::steady_clock::now() - _start;
+    int64_t usecs = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+
+    bool queued = _ring.push_with([&](LogRecord &rec) {
+      rec.usecs = usecs;
+      rec.level = level;
+      vsnprintf(rec.text, sizeof(rec.text), fmt, ap);
+    });
+    if (not queued)
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void drain(void)
+  {
+    // one drainer at a time so lines keep their order
+    std::lock_guard<std::mutex> lock(_drain_mutex);
+
+    uint32_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped)
+      fprintf(stderr, "[W] log dropped %u messages\n", dropped);
+
+    while (_ring.pop_with([](LogRecord &rec) { print(rec); }))
+      ;
+    fflush(stderr);
+  }
+
+private:
+  static void print(const LogRecord &rec)
+  {
+    int32_t level = rec.level < FT232GPIO_LOG_OFF ? rec.level : FT232GPIO_LOG_ERROR;
+    fprintf(stderr, "[%c] %lld.%06lld %s\n", _level_char[level], (long long)(rec.usecs / 1000000),
+            (long long)(rec.usecs % 1000000), rec.text);
+  }
+
+  void drain_loop(void)
+  {
+    while (not _stop)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(LOG_DRAIN_MSEC));
+      drain();
+    }
+  }
+
+private:
+  RingQueue<LogRecord, LOG_RING_SIZE> _ring;
+  std::atomic<uint32_t> _dropped{0};
+  std::chrono::steady_clock::time_point _start;
+  std::mutex _drain_mutex;
+  std::atomic<bool> _stop{false};
+  std::thread _thread;
+};
+
+Logger &logger(void)
+{
+  static Logger _logger;
+  return _logger;
+}
+
+} // namespace
+
+void log_write(int level, const char *fmt, ...)
+{
+  va_list ap;
+  va_start(ap, fmt);
+  logger().write(level, fmt, ap);
+  va_end(ap);
+}
+
+void log_flush(void)
+{
+  //
+  logger().drain();
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,289 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/metrics.h"
+#include "ft232gpio/log.h"
+
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ft232gpio
+{
+
+namespace
+{
+
+// hwmon drivers of CPU packages, temp1 is the package or die
+const char *const _hwmon_names[] = {"coretemp", "k10temp", "zenpower", "cpu_thermal", nullptr};
+// thermal zones of CPUs, other zones may be a battery or wifi chip
+const char *const _zone_types[] = {"x86_pkg_temp", "cpu-thermal", "cpu_thermal", "soc-thermal",
+                                   "soc_thermal", nullptr};
+
+// first line of a small sysfs file without the newline
+bool read_line(const char *path, char *buf, size_t size)
+{
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+  ssize_t len = ::read(fd, buf, size - 1);
+  ::close(fd);
+  if (len <= 0)
+    return false;
+  buf[len] = '\0';
+  buf[strcspn(buf, "\n")] = '\0';
+  return true;
+}
+
+// path of the entry in dir whose name file matches one of names, in the
+// order of names
+bool find_by_name(const char *dir, const char *prefix, const char *name_file,
+                  const char *const *names, const char *file, char *path, size_t size)
+{
+  DIR *d = opendir(dir);
+  if (d == nullptr)
+    return false;
+
+  int32_t best = -1;
+  char name[64];
+  char entry_path[METRICS_PATH_MAX];
+  while (struct dirent *entry = readdir(d))
+  {
+    if (strncmp(entry->d_name, prefix, strlen(prefix)) != 0)
+      continue;
+    int len = snprintf(entry_path, sizeof(entry_path), "%s/%s/%s", dir, entry->d_name, name_file);
+    if (len >= int(sizeof(entry_path)) || not read_line(entry_path, name, sizeof(name)))
+      continue;
+    for (int32_t i = 0; names[i] && (best < 0 || i < best); ++i)
+    {
+      if (strcmp(name, names[i]) != 0)
+        continue;
+      len = snprintf(entry_path, sizeof(entry_path), "%s/%s/%s", dir, entry->d_name, file);
+      if (len >= int(sizeof(entry_path)) || access(entry_path, R_OK) != 0)
+        continue;
+      best = i;
+      snprintf(path, size, "%s", entry_path);
+    }
+  }
+  closedir(d);
+  return best >= 0;
+}
+
+const char *skip_spaces(const char *p)
+{
+  while (*p == ' ' || *p == '\t')
+    p++;
+  return p;
+}
+
+const char *parse_u64(const char *p, uint64_t &value)
+{
+  p = skip_spaces(p);
+  value = 0;
+  while (*p >= '0' && *p <= '9')
+    value = value * 10 + (*p++ - '0');
+  return p;
+}
+
+// loadavg values, x.yy
+const char *parse_fixed(const char *p, float &value)
+{
+  uint64_t whole, frac = 0, scale = 1;
+  p = parse_u64(p, whole);
+  if (*p == '.')
+  {
+    p++;
+    while (*p >= '0' && *p <= '9')
+    {
+      frac = frac * 10 + (*p++ - '0');
+      scale *= 10;
+    }
+  }
+  value = float(whole) + float(frac) / float(scale);
+  return p;
+}
+
+const char *next_line(const char *p)
+{
+  p = strchr(p, '\n');
+  return p ? p + 1 : nullptr;
+}
+
+} // namespace
+
+Metrics::~Metrics()
+{
+  //
+  release();
+}
+
+bool Metrics::init(void)
+{
+  release();
+
+  if (find_temperature())
+    _fd_temp = ::open(_temp_path, O_RDONLY | O_CLOEXEC);
+  else
+    FT232GPIO_WARN("Metrics: no CPU temperature sensor");
+  _fd_meminfo = ::open("/proc/meminfo", O_RDONLY | O_CLOEXEC);
+  _fd_loadavg = ::open("/proc/loadavg", O_RDONLY | O_CLOEXEC);
+  _fd_stat = ::open("/proc/stat", O_RDONLY | O_CLOEXEC);
+
+  FT232GPIO_DEBUG("Metrics: temperature %s", _temp_path);
+  return _fd_temp >= 0 || _fd_meminfo >= 0 || _fd_loadavg >= 0 || _fd_stat >= 0;
+}
+
+void Metrics::release(void)
+{
+  for (int *fd : {&_fd_temp, &_fd_meminfo, &_fd_loadavg, &_fd_stat})
+  {
+    if (*fd >= 0)
+      ::close(*fd);
+    *fd = -1;
+  }
+  _temp_path[0] = '\0';
+  memset(_cpu_busy, 0, sizeof(_cpu_busy));
+  memset(_cpu_total, 0, sizeof(_cpu_total));
+}
+
+bool Metrics::temperature(int32_t &millic)
+{
+  int32_t len = read(_fd_temp, _buf, 32);
+  if (len <= 0)
+    return false;
+
+  const char *p = _buf;
+  bool negative = *p == '-';
+  uint64_t value;
+  parse_u64(negative ? p + 1 : p, value);
+  millic = negative ? -int32_t(value) : int32_t(value);
+  return true;
+}
+
+bool Metrics::meminfo(MemInfo &info)
+{
+  if (read(_fd_meminfo, _buf, sizeof(_buf)) <= 0)
+    return false;
+
+  // lines are "Key:   value kB", in an order that differs between kernels
+  struct Field
+  {
+    const char *key;
+    size_t len;
+    uint64_t *value;
+  };
+  const Field fields[] = {{"MemTotal:", 9, &info.total_kb},
+                          {"MemFree:", 8, &info.free_kb},
+                          {"MemAvailable:", 13, &info.available_kb}};
+  uint32_t found = 0;
+  for (const char *p = _buf; p && found < 3; p = next_line(p))
+  {
+    for (auto &field : fields)
+    {
+      if (strncmp(p, field.key, field.len) == 0)
+      {
+        parse_u64(p + field.len, *field.value);
+        found++;
+        break;
+      }
+    }
+  }
+  return found == 3;
+}
+
+bool Metrics::loadavg(LoadAvg &load)
+{
+  if (read(_fd_loadavg, _buf, 128) <= 0)
+    return false;
+
+  const char *p = _buf;
+  p = parse_fixed(p, load.one);
+  p = parse_fixed(p, load.five);
+  parse_fixed(p, load.fifteen);
+  return true;
+}
+
+int32_t Metrics::cpu_usage(uint8_t *percent, int32_t count)
+{
+  if (read(_fd_stat, _buf, sizeof(_buf)) <= 0)
+    return -1;
+
+  // cpuN user nice system idle iowait irq softirq steal, guest time is
+  // already in user and nice
+  int32_t cores = 0;
+  for (const char *p = next_line(_buf); p && cores < count && cores < METRICS_CPUS_MAX;
+       p = next_line(p))
+  {
+    if (strncmp(p, "cpu", 3) != 0 || p[3] < '0' || p[3] > '9')
+      break;
+    p += 3;
+    while (*p >= '0' && *p <= '9')
+      p++;
+
+    uint64_t values[8] = {0};
+    for (auto &value : values)
+      p = parse_u64(p, value);
+    uint64_t total = 0;
+    for (auto value : values)
+      total += value;
+    uint64_t busy = total - values[3] - values[4];
+
+    uint64_t dtotal = total - _cpu_total[cores];
+    uint64_t dbusy = busy - _cpu_busy[cores];
+    percent[cores] = dtotal ? uint8_t(dbusy * 100 / dtotal) : 0;
+    _cpu_total[cores] = total;
+    _cpu_busy[cores] = busy;
+    cores++;
+  }
+  return cores;
+}
+
+bool Metrics::find_temperature(void)
+{
+  if (find_by_name("/sys/class/hwmon", "hwmon", "name", _hwmon_names, "temp1_input", _temp_path,
+                   sizeof(_temp_path)))
+    return true;
+  if (find_by_name("/sys/class/thermal", "thermal_zone", "type", _zone_types, "temp", _temp_path,
+                   sizeof(_temp_path)))
+    return true;
+
+  // any zone is better than none, zone 0 is the SoC on most boards
+  snprintf(_temp_path, sizeof(_temp_path), "/sys/class/thermal/thermal_zone0/temp");
+  if (access(_temp_path, R_OK) == 0)
+    return true;
+  _temp_path[0] = '\0';
+  return false;
+}
+
+int32_t Metrics::read(int fd, char *buf, int32_t size)
+{
+  if (fd < 0)
+    return -1;
+
+  // sysfs and procfs regenerate the contents on a read from offset 0
+  ssize_t len = ::pread(fd, buf, size - 1, 0);
+  if (len < 0)
+    return -1;
+  buf[len] = '\0';
+  return int32_t(len);
+}
+
+} // namespace ft232gpio
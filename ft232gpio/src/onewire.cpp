@@ -0,0 +1,250 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Timing from Maxim AN126, standard speed
+
+#include "ft232gpio/onewire.h"
+#include "ft232gpio/log.h"
+
+#include <cassert>
+
+// usecs low, released until sample and rest of slot
+#define RESET_LOW 480
+#define RESET_WAIT 70
+#define RESET_REST 410
+#define WRITE1_LOW 6
+#define WRITE1_REST 64
+#define WRITE0_LOW 60
+#define WRITE0_REST 10
+#define READ_LOW 6
+#define READ_WAIT 9
+#define READ_REST 55
+
+namespace ft232gpio
+{
+
+void OneWire::pins(uint8_t tx, uint8_t rx)
+{
+  assert(not _initalized);
+  _pin_tx = tx;
+  _pin_rx = rx;
+}
+
+bool OneWire::init(FT232 *ft232)
+{
+  _ft232 = ft232;
+  _initalized = true;
+
+  // RX only reads the bus, release the bus with TX
+  _ft232->inputs(_ft232->inputs() | _pin_rx);
+  _ft232->write_pins(_pin_tx, _pin_tx);
+
+  _out.clear();
+  _breaks.clear();
+  _reads.clear();
+  _presence.clear();
+  return true;
+}
+
+void OneWire::release(void)
+{
+  if (_ft232 == nullptr)
+  {
+    assert(false);
+    return;
+  }
+
+  _ft232->write_pins(_pin_tx, _pin_tx);
+  _ft232->inputs(_ft232->inputs() & ~_pin_rx);
+
+  _initalized = false;
+  _ft232 = nullptr;
+}
+
+void OneWire::reset(void)
+{
+  //
+  _presence.push_back(slot(RESET_LOW, RESET_WAIT, RESET_REST));
+}
+
+void OneWire::write(const uint8_t *data, int32_t length)
+{
+  for (int32_t i = 0; i < length; ++i)
+    for (int32_t b = 0; b < 8; ++b)
+      write_bit((data[i] >> b) & 1); // LSB first
+}
+
+void OneWire::read(int32_t length)
+{
+  for (int32_t i = 0; i < length * 8; ++i)
+    read_bit();
+}
+
+bool OneWire::commit(uint8_t *in)
+{
+  if (not _initalized)
+  {
+    assert(false);
+    return false;
+  }
+
+  FT232Batch batch(_ft232);
+
+  // slots hold only TX, other pins keep their values
+  const uint8_t base = _ft232->port() & ~_pin_tx;
+  for (auto &sample : _out)
+    sample |= base;
+
+  bool ok = true;
+  if (_reads.empty() && _presence.empty())
+    ok = _ft232->write_data(_out.data(), _out.size());
+  else
+  {
+    _in.resize(_out.size());
+    ok = _ft232->transfer(_out.data(), _in.data(), _out.size(), 0xFF & ~_pin_rx, &_breaks);
+
+    // device pulls the bus low for presence
+    for (auto s : _presence)
+      ok = ok && (_in[s] & _pin_rx) == 0;
+
+    for (size_t i = 0; in && i < _reads.size(); ++i)
+    {
+      if (i % 8 == 0)
+        in[i / 8] = 0;
+      if (_in[_reads[i]] & _pin_rx)
+        in[i / 8] |= 1 << (i % 8);
+    }
+  }
+
+  _out.clear();
+  _breaks.clear();
+  _reads.clear();
+  _presence.clear();
+  return batch.end() && ok;
+}
+
+bool OneWire::search(std::vector<uint64_t> &roms, uint8_t family)
+{
+  // Maxim AN187, discrepancy is the 1 based bit where 0 was taken last pass
+  roms.clear();
+  uint64_t rom = 0;
+  int32_t last_discrepancy = 0;
+
+  FT232Batch batch(_ft232);
+  do
+  {
+    reset();
+    write_byte(ONEWIRE_SEARCH_ROM);
+
+    int32_t last_zero = 0;
+    for (int32_t b = 1; b <= 64; ++b)
+    {
+      // bit and its complement, sent with the direction taken for last bit
+      uint8_t in = 0;
+      read_bit();
+      read_bit();
+      if (not commit(&in))
+        return false; // no presence or transfer failed
+      bool id_bit = in & 0x01;
+      bool cmp_bit = in & 0x02;
+      if (id_bit && cmp_bit)
+        return false; // devices went away
+
+      bool direction = id_bit;
+      if (id_bit == cmp_bit)
+      {
+        // devices differ at this bit
+        if (b < last_discrepancy)
+          direction = (rom >> (b - 1)) & 1;
+        else
+          direction = b == last_discrepancy;
+        if (not direction)
+          last_zero = b;
+      }
+      uint64_t mask = uint64_t(1) << (b - 1);
+      rom = direction ? rom | mask : rom & ~mask;
+      write_bit(direction);
+    }
+    if (not commit())
+      return false;
+
+    uint8_t bytes[8];
+    for (int32_t i = 0; i < 8; ++i)
+      bytes[i] = rom >> (8 * i);
+    if (crc8(bytes, 7) != bytes[7])
+      FT232GPIO_WARN("OneWire search crc error %016llx", (unsigned long long)rom);
+    else if (family == 0 || bytes[0] == family)
+      roms.push_back(rom);
+
+    last_discrepancy = last_zero;
+  } while (last_discrepancy != 0);
+
+  return batch.end();
+}
+
+uint8_t OneWire::crc8(const uint8_t *data, int32_t length)
+{
+  // x^8 + x^5 + x^4 + 1, LSB first
+  uint8_t crc = 0;
+  for (int32_t i = 0; i < length; ++i)
+  {
+    uint8_t b = data[i];
+    for (int32_t bit = 0; bit < 8; ++bit)
+    {
+      bool mix = (crc ^ b) & 1;
+      crc >>= 1;
+      if (mix)
+        crc ^= 0x8C;
+      b >>= 1;
+    }
+  }
+  return crc;
+}
+
+//
+// OneWire privates
+//
+
+uint32_t OneWire::slot(uint32_t low, uint32_t wait, uint32_t rest)
+{
+  // bus is low while TX is low, pulled up by the resistor when released
+  _out.insert(_out.end(), _ft232->samples(low), 0);
+  _out.insert(_out.end(), wait ? _ft232->samples(wait) : 0, _pin_tx);
+  uint32_t sample = _out.size() - 1;
+  _out.insert(_out.end(), _ft232->samples(rest), _pin_tx);
+
+  // transfer may pause once the bus is released and sampled
+  if (wait)
+    _breaks.push_back(sample + 1);
+  _breaks.push_back(_out.size());
+  return sample;
+}
+
+void OneWire::write_bit(bool bit)
+{
+  if (bit)
+    slot(WRITE1_LOW, 0, WRITE1_REST);
+  else
+    slot(WRITE0_LOW, 0, WRITE0_REST);
+}
+
+void OneWire::read_bit(void)
+{
+  //
+  _reads.push_back(slot(READ_LOW, READ_WAIT, READ_REST));
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/profile.h"
+#include "ft232gpio/log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <sys/stat.h>
+
+#define PROFILE_LINE_MAX 256
+#define PROFILE_VALUES_MAX 8
+
+namespace ft232gpio
+{
+
+namespace
+{
+
+// timing structs are plain uint32_t fields
+template <typename T> uint32_t *fields(T &timing) { return reinterpret_cast<uint32_t *>(&timing); }
+template <typename T> const uint32_t *fields(const T &timing)
+{
+  return reinterpret_cast<const uint32_t *>(&timing);
+}
+template <typename T> constexpr size_t field_count(void) { return sizeof(T) / sizeof(uint32_t); }
+
+static_assert(field_count<I2CTiming>() <= PROFILE_VALUES_MAX, "I2CTiming");
+static_assert(field_count<TM1637Timing>() <= PROFILE_VALUES_MAX, "TM1637Timing");
+static_assert(field_count<LCDTiming>() <= PROFILE_VALUES_MAX, "LCDTiming");
+
+bool make_parents(const std::string &path)
+{
+  for (size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1))
+  {
+    std::string dir = path.substr(0, pos);
+    if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+bool TimingProfiles::load(const std::string &path)
+{
+  FILE *file = fopen(path.c_str(), "r");
+  if (file == nullptr)
+    return false;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  char line[PROFILE_LINE_MAX];
+  int32_t number = 0;
+  while (fgets(line, sizeof(line), file))
+  {
+    number++;
+    char serial[64], kind[16];
+    uint32_t addr;
+    int used = 0;
+    if (line[0] == '#' || line[0] == '\n')
+      continue;
+    if (sscanf(line, "%63s %15s %" SCNx32 "%n", serial, kind, &addr, &used) != 3)
+    {
+      FT232GPIO_WARN("%s:%d: bad profile", path.c_str(), number);
+      continue;
+    }
+
+    std::vector<uint32_t> values;
+    const char *p = line + used;
+    uint32_t value;
+    int n;
+    while (values.size() < PROFILE_VALUES_MAX && sscanf(p, "%" SCNu32 "%n", &value, &n) == 1)
+    {
+      values.push_back(value);
+      p += n;
+    }
+    _profiles[Key(serial, kind, addr)] = values;
+  }
+  fclose(file);
+
+  FT232GPIO_DEBUG("TimingProfiles::load %s %zu", path.c_str(), _profiles.size());
+  return true;
+}
+
+bool TimingProfiles::save(const std::string &path) const
+{
+  if (not make_parents(path))
+  {
+    FT232GPIO_ERROR("TimingProfiles::save %s: %s", path.c_str(), strerror(errno));
+    return false;
+  }
+
+  // written aside and renamed, so readers never see half a file
+  std::string temp = path + ".tmp";
+  FILE *file = fopen(temp.c_str(), "w");
+  if (file == nullptr)
+  {
+    FT232GPIO_ERROR("TimingProfiles::save %s: %s", temp.c_str(), strerror(errno));
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    fprintf(file, "# serial kind addr usecs...\n");
+    for (auto &profile : _profiles)
+    {
+      fprintf(file, "%s %s 0x%02" PRIx32, std::get<0>(profile.first).c_str(),
+              std::get<1>(profile.first).c_str(), std::get<2>(profile.first));
+      for (auto value : profile.second)
+        fprintf(file, " %" PRIu32, value);
+      fprintf(file, "\n");
+    }
+  }
+
+  bool ok = fclose(file) == 0 && rename(temp.c_str(), path.c_str()) == 0;
+  if (not ok)
+    FT232GPIO_ERROR("TimingProfiles::save %s: %s", path.c_str(), strerror(errno));
+  return ok;
+}
+
+std::string TimingProfiles::default_path(void)
+{
+  const char *path = getenv(TIMING_PROFILE_ENV);
+  if (path && *path)
+    return path;
+  const char *home = getenv("HOME");
+  return std::string(home ? home : ".") + "/.config/ft232gpio/timing";
+}
+
+bool TimingProfiles::lookup(const std::string &serial, uint32_t addr, I2CTiming &timing) const
+{
+  return get(key(serial, "i2c", addr), fields(timing), field_count<I2CTiming>());
+}
+
+bool TimingProfiles::lookup(const std::string &serial, uint32_t addr, TM1637Timing &timing) const
+{
+  return get(key(serial, "tm1637", addr), fields(timing), field_count<TM1637Timing>());
+}
+
+bool TimingProfiles::lookup(const std::string &serial, uint32_t addr, LCDTiming &timing) const
+{
+  return get(key(serial, "lcd", addr), fields(timing), field_count<LCDTiming>());
+}
+
+void TimingProfiles::store(const std::string &serial, uint32_t addr, const I2CTiming &timing)
+{
+  set(key(serial, "i2c", addr), fields(timing), field_count<I2CTiming>());
+}
+
+void TimingProfiles::store(const std::string &serial, uint32_t addr, const TM1637Timing &timing)
+{
+  set(key(serial, "tm1637", addr), fields(timing), field_count<TM1637Timing>());
+}
+
+void TimingProfiles::store(const std::string &serial, uint32_t addr, const LCDTiming &timing)
+{
+  set(key(serial, "lcd", addr), fields(timing), field_count<LCDTiming>());
+}
+
+bool TimingProfiles::get(const Key &key, uint32_t *values, size_t count) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  auto it = _profiles.find(key);
+  if (it == _profiles.end())
+    return false;
+  // a profile from another version with other fields is not used
+  if (it->second.size() != count)
+  {
+    FT232GPIO_WARN("timing profile %s %s has %zu values", std::get<0>(key).c_str(),
+                   std::get<1>(key).c_str(), it->second.size());
+    return false;
+  }
+  std::copy(it->second.begin(), it->second.end(), values);
+  return true;
+}
+
+void TimingProfiles::set(const Key &key, const uint32_t *values, size_t count)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _profiles[key].assign(values, values + count);
+}
+
+TimingProfiles::Key TimingProfiles::key(const std::string &serial, const char *kind, uint32_t addr)
+{
+  // adapters without a serial share one profile
+  return Key(serial.empty() ? "-" : serial, kind, addr);
+}
+
+TimingProfiles &timing_profiles(void)
+{
+  static TimingProfiles _profiles;
+  static std::once_flag _loaded;
+  std::call_once(_loaded, [] { _profiles.load(TimingProfiles::default_path()); });
+  return _profiles;
+}
+
+} // namespace ft232gpio
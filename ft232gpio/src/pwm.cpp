@@ -0,0 +1,178 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ft232gpio/pwm.h"
+#include "ft232gpio/log.h"
+
+#include <cassert>
+#include <chrono>
+#include <deque>
+
+// a buffer is at least this many samples so short periods do not turn
+// into many small USB transfers, about 13ms
+#define PWM_BUFFER_MIN 2048
+
+namespace ft232gpio
+{
+
+PWM::~PWM()
+{
+  //
+  stop();
+}
+
+bool PWM::start(FT232 *ft232, uint8_t pins, uint32_t period_usecs)
+{
+  if (_running || pins == 0)
+    return false;
+
+  _ft232 = ft232;
+  _pins = pins;
+  _period = _ft232->samples(period_usecs);
+  _repeat = (PWM_BUFFER_MIN + _period - 1) / _period;
+  {
+    std::lock_guard<std::mutex> lock(_duty_mutex);
+    for (auto &high : _high)
+      high = 0;
+    _generation++;
+  }
+  for (auto &buffer : _buffers)
+    buffer.generation = _generation - 1; // build on first use
+
+  FT232GPIO_DEBUG("PWM pins 0x%02x period %u samples x %u", _pins, _period, _repeat);
+
+  _running = true;
+  _thread = std::thread(&PWM::run, this);
+  return true;
+}
+
+void PWM::stop(void)
+{
+  if (not _running)
+    return;
+
+  _running = false;
+  if (_thread.joinable())
+    _thread.join();
+
+  _ft232->write_pins(_pins, 0x00);
+}
+
+void PWM::duty(uint8_t pin, uint32_t permille)
+{
+  permille = permille > 1000 ? 1000 : permille;
+  high(pin, (uint64_t(_period) * permille + 500) / 1000);
+}
+
+void PWM::pulse(uint8_t pin, uint32_t usecs)
+{
+  //
+  high(pin, usecs ? _ft232->samples(usecs) : 0);
+}
+
+//
+// PWM privates
+//
+
+void PWM::high(uint8_t pin, uint32_t samples)
+{
+  assert((pin & _pins) == pin && pin != 0);
+
+  std::lock_guard<std::mutex> lock(_duty_mutex);
+  for (int32_t c = 0; c < PWM_CHANNELS; ++c)
+  {
+    if (pin & (1 << c))
+      _high[c] = samples < _period ? samples : _period;
+  }
+  _generation++;
+}
+
+void PWM::build(std::vector<uint8_t> &buffer, uint8_t base)
+{
+  // one period, then copies of it
+  buffer.assign(_period, base);
+  for (int32_t c = 0; c < PWM_CHANNELS; ++c)
+  {
+    uint8_t bit = 1 << c;
+    if (_pins & bit)
+    {
+      for (uint32_t s = 0; s < _high[c]; ++s)
+        buffer[s] |= bit;
+    }
+  }
+  buffer.reserve(_period * _repeat);
+  for (uint32_t r = 1; r < _repeat; ++r)
+    buffer.insert(buffer.end(), buffer.begin(), buffer.begin() + _period);
+}
+
+void PWM::run(void)
+{
+  std::deque<FT232Transfer> flight;
+  uint32_t next = 0;
+
+  while (_running)
+  {
+    Buffer &buffer = _buffers[next];
+    next = (next + 1) % PWM_BUFFERS;
+
+    FT232Transfer transfer;
+    {
+      // port lock, so other pins do not change while the buffer is made
+      FT232Batch batch(_ft232);
+      uint8_t base = _ft232->port() & ~_pins;
+
+      std::lock_guard<std::mutex> lock(_duty_mutex);
+      if (buffer.generation != _generation || buffer.base != base)
+      {
+        build(buffer.samples, base);
+        buffer.generation = _generation;
+        buffer.base = base;
+      }
+      transfer = _ft232->write_submit(buffer.samples.data(), buffer.samples.size());
+    }
+
+    if (transfer.control)
+      flight.push_back(transfer);
+    else
+    {
+      // device is lost or busy, transfers in flight are finished or were
+      // dropped with the device. wait a period before trying again
+      while (not flight.empty())
+      {
+        _ft232->write_wait(flight.front());
+        flight.pop_front();
+      }
+      auto usecs = uint64_t(_period) * 1000000 / _ft232->sample_rate();
+      std::this_thread::sleep_for(std::chrono::microseconds(usecs));
+      continue;
+    }
+
+    // keep one transfer queued behind the one being sent
+    if (flight.size() >= PWM_BUFFERS - 1)
+    {
+      _ft232->write_wait(flight.front());
+      flight.pop_front();
+    }
+  }
+
+  while (not flight.empty())
+  {
+    _ft232->write_wait(flight.front());
+    flight.pop_front();
+  }
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ft232gpio/seg7.h"
+
+namespace ft232gpio
+{
+
+namespace
+{
+
+bool overflow(uint8_t *out, int32_t count)
+{
+  for (int32_t i = 0; i < count; ++i)
+    out[i] = SEG7_MINUS;
+  return false;
+}
+
+// right aligned decimal with at least min_digits digits
+bool decimal(uint8_t *out, int32_t count, int32_t value, int32_t min_digits, bool zero_pad)
+{
+  bool negative = value < 0;
+  uint32_t mag = negative ? uint32_t(-(int64_t)value) : uint32_t(value);
+
+  int32_t pos = count - 1;
+  int32_t digits = 0;
+  while (pos >= 0 && (mag != 0 || digits < min_digits))
+  {
+    out[pos--] = SEG7_HEX[mag % 10];
+    mag /= 10;
+    digits++;
+  }
+  if (mag != 0 || digits < min_digits || (negative && pos < 0))
+    return overflow(out, count);
+
+  int32_t sign = zero_pad ? 0 : pos;
+  while (pos >= 0)
+    out[pos--] = zero_pad ? SEG7_HEX[0] : SEG7_BLANK;
+  if (negative)
+    out[sign] = SEG7_MINUS;
+  return true;
+}
+
+} // namespace
+
+bool seg7_text(uint8_t *out, int32_t count, const char *text)
+{
+  int32_t pos = 0;
+  for (; *text != '\0'; ++text)
+  {
+    if (*text == '.' && pos > 0 && !(out[pos - 1] & SEG7_DP))
+    {
+      out[pos - 1] |= SEG7_DP;
+      continue;
+    }
+    if (pos >= count)
+      return false; // truncated
+    out[pos++] = *text == '.' ? SEG7_DP : seg7_char(*text);
+  }
+  while (pos < count)
+    out[pos++] = SEG7_BLANK;
+  return true;
+}
+
+bool seg7_int(uint8_t *out, int32_t count, int32_t value, bool zero_pad)
+{
+  // keep the first digit for the sign when zero padded
+  int32_t min_digits = zero_pad ? count - (value < 0 ? 1 : 0) : 1;
+  return decimal(out, count, value, min_digits, zero_pad);
+}
+
+bool seg7_hex(uint8_t *out, int32_t count, uint32_t value)
+{
+  for (int32_t pos = count - 1; pos >= 0; --pos)
+  {
+    out[pos] = SEG7_HEX[value & 0x0f];
+    value >>= 4;
+  }
+  if (value != 0)
+    return overflow(out, count);
+  return true;
+}
+
+bool seg7_fixed(uint8_t *out, int32_t count, int32_t value, int32_t decimals)
+{
+  // at least one digit before the point, 5 with 2 decimals shows 0.05
+  if (decimals < 0 || decimals >= count)
+    return overflow(out, count);
+  if (not decimal(out, count, value, decimals + 1, false))
+    return false;
+  if (decimals > 0)
+    out[count - 1 - decimals] |= SEG7_DP;
+  return true;
+}
+
+bool seg7_time(uint8_t *out, int32_t hour, int32_t minute, bool colon)
+{
+  if (hour < 0 || hour > 99 || minute < 0 || minute > 59)
+    return overflow(out, 4);
+
+  out[0] = SEG7_HEX[hour / 10];
+  out[1] = SEG7_HEX[hour % 10] | (colon ? SEG7_DP : 0);
+  out[2] = SEG7_HEX[minute / 10];
+  out[3] = SEG7_HEX[minute % 10];
+  return true;
+}
+
+bool seg7_temp(uint8_t *out, int32_t count, int32_t tenths)
+{
+  if (count < 2)
+    return overflow(out, count);
+
+  out[count - 1] = SEG7_DEGREE;
+  if (seg7_fixed(out, count - 1, tenths, 1))
+    return true;
+
+  // round to whole degrees
+  int32_t whole = (tenths + (tenths < 0 ? -5 : 5)) / 10;
+  if (decimal(out, count - 1, whole, 1, false))
+    return true;
+
+  out[count - 1] = SEG7_MINUS;
+  return false;
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/sim_bus.h"
+
+namespace ft232gpio
+{
+
+SimTwoWire::SimTwoWire(uint8_t pin_clock, uint8_t pin_data, const SimBusTiming &timing,
+                       bool lsb_first)
+  : _pin_clock(pin_clock), _pin_data(pin_data), _timing(timing), _lsb_first(lsb_first)
+{
+  //
+}
+
+void SimTwoWire::sample(uint8_t pins)
+{
+  bool clock = (pins & _pin_clock) != 0;
+  bool data = (pins & _pin_data) != 0;
+
+  if (_first)
+  {
+    _clock = clock;
+    _data = data;
+    _first = false;
+    return;
+  }
+
+  if (clock != _clock && not clock)
+    clock_fall();
+  if (data != _data)
+    data_change(data);
+  if (clock != _clock && clock)
+    clock_rise();
+}
+
+void SimTwoWire::clock_fall(void)
+{
+  uint64_t now = nsecs();
+
+  if (_started && now - _clock_at < _timing.high_ns)
+    violation("clock high %llu < %u ns", (unsigned long long)(now - _clock_at), _timing.high_ns);
+  if (_start_hold && now - _start_at < _timing.start_hold_ns)
+    violation("start hold %llu < %u ns", (unsigned long long)(now - _start_at),
+              _timing.start_hold_ns);
+  _start_hold = false;
+  _acking = _started && _bits == 8 && _ack;
+  _tx_low = _started && _sending && _bits < 8 &&
+            ((_tx >> (_lsb_first ? _bits : 7 - _bits)) & 1) == 0;
+
+  _clock = false;
+  _clock_at = now;
+}
+
+void SimTwoWire::data_change(bool data)
+{
+  uint64_t now = nsecs();
+
+  _data = data;
+  _data_at = now;
+
+  if (not _clock)
+  {
+    if (_started && now - _rise_at < _timing.hold_ns)
+      violation("data hold %llu < %u ns", (unsigned long long)(now - _rise_at), _timing.hold_ns);
+    return;
+  }
+
+  if (not data)
+  {
+    // start, or repeated start
+    _started = true;
+    _start_hold = true;
+    _start_at = now;
+    _bits = 0;
+    _byte = 0;
+    _lost = false;
+    _ack = false;
+    _acking = false;
+    _sending = false;
+    _tx_low = false;
+    on_start();
+    return;
+  }
+
+  if (not _started)
+    return;
+  if (now - _clock_at < _timing.stop_setup_ns)
+    violation("stop setup %llu < %u ns", (unsigned long long)(now - _clock_at),
+              _timing.stop_setup_ns);
+  // the clock rise before a stop is counted as a bit
+  if (_bits > 1)
+    violation("stop after %u bits", _bits - 1);
+  _started = false;
+  _acking = false;
+  _sending = false;
+  _tx_low = false;
+  on_stop();
+}
+
+void SimTwoWire::clock_rise(void)
+{
+  uint64_t now = nsecs();
+
+  if (_started)
+  {
+    if (now - _clock_at < _timing.low_ns)
+      violation("clock low %llu < %u ns", (unsigned long long)(now - _clock_at), _timing.low_ns);
+    if (now - _data_at < _timing.setup_ns)
+      violation("data setup %llu < %u ns", (unsigned long long)(now - _data_at),
+                _timing.setup_ns);
+
+    if (_bits < 8)
+    {
+      if (_lsb_first)
+        _byte |= (_data ? 1 : 0) << _bits;
+      else
+        _byte = (_byte << 1) | (_data ? 1 : 0);
+    }
+    if (++_bits == 8)
+      _ack = not _sending && not _lost && ack(_byte);
+    else if (_bits == 9)
+    {
+      if (_sending)
+      {
+        // host acknowledges with data low to take one more byte
+        _sending = not _data && not _lost && transmit(_tx);
+      }
+      else
+      {
+        // acknowledge of the host is not checked
+        if (not _lost)
+          on_byte(_byte);
+        _sending = _ack && not _lost && transmit(_tx);
+      }
+      _bits = 0;
+      _byte = 0;
+    }
+  }
+
+  _clock = true;
+  _clock_at = now;
+  _rise_at = now;
+}
+
+void SimTwoWire::on_violation(void)
+{
+  //
+  _lost = _lost || _started;
+}
+
+} // namespace ft232gpio
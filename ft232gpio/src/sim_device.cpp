@@ -0,0 +1,61 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/sim_device.h"
+#include "ft232gpio/log.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+namespace ft232gpio
+{
+
+void SimDevice::feed(const uint8_t *buf, int size, uint32_t sample_rate)
+{
+  const uint64_t period = 1000000000ull / sample_rate;
+  for (int i = 0; i < size; ++i)
+  {
+    sample(buf[i]);
+    _nsecs += period;
+  }
+}
+
+void SimDevice::clear_violations(void)
+{
+  _violation_count = 0;
+  _violations.clear();
+}
+
+void SimDevice::violation(const char *fmt, ...)
+{
+  _violation_count++;
+  on_violation();
+  if (_violations.size() >= SIM_VIOLATIONS_MAX)
+    return;
+
+  char text[128];
+  int len = snprintf(text, sizeof(text), "%llu ns: ", (unsigned long long)_nsecs);
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(text + len, sizeof(text) - len, fmt, ap);
+  va_end(ap);
+
+  FT232GPIO_DEBUG("violation %s", text);
+  _violations.push_back(text);
+}
+
+} // namespace ft232gpio
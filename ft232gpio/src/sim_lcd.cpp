@@ -0,0 +1,290 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/sim_lcd.h"
+
+#include <cstring>
+
+// waits of initialization by instruction, after the first and the second
+// 8bit function set
+#define HD44780_RESET1_NS 4100000
+#define HD44780_RESET2_NS 100000
+
+namespace ft232gpio
+{
+
+PCF8574Model::PCF8574Model(uint8_t addr, uint8_t scl, uint8_t sda, const SimBusTiming &timing)
+  : SimTwoWire(scl, sda, timing, false), _addr(addr)
+{
+  //
+}
+
+void PCF8574Model::on_port(std::function<void(uint8_t port, uint64_t nsecs)> listener)
+{
+  //
+  _listener = std::move(listener);
+}
+
+void PCF8574Model::on_start(void)
+{
+  _index = 0;
+  _selected = false;
+  _reading = false;
+}
+
+bool PCF8574Model::ack(uint8_t byte)
+{
+  // reads are acknowledged too, they return the port
+  if (_index == 0)
+    return (byte >> 1) == _addr;
+  return _selected;
+}
+
+void PCF8574Model::on_byte(uint8_t byte)
+{
+  if (_index++ == 0)
+  {
+    _selected = (byte >> 1) == _addr && (byte & 0x01) == 0;
+    _reading = (byte >> 1) == _addr && (byte & 0x01) != 0;
+    return;
+  }
+  if (not _selected)
+    return;
+
+  // port is latched at the acknowledge of each data byte
+  _port = byte;
+  if (_listener)
+    _listener(_port, nsecs());
+}
+
+bool PCF8574Model::transmit(uint8_t &byte)
+{
+  // quasi-bidirectional, a pin written low reads low
+  byte = _port & _inputs;
+  return _reading;
+}
+
+HD44780Model::HD44780Model(const HD44780Pins &pins, const LCDGeometry &geometry,
+                           const HD44780Timing &timing)
+  : _pins(pins), _geometry(geometry), _timing(timing)
+{
+  //
+  memset(_ddram, ' ', sizeof(_ddram));
+}
+
+void HD44780Model::sample(uint8_t pins)
+{
+  //
+  input(pins, nsecs());
+}
+
+void HD44780Model::input(uint8_t value, uint64_t now)
+{
+  nsecs(now);
+
+  if (_first)
+  {
+    _value = value;
+    _first = false;
+    return;
+  }
+
+  const uint8_t data_mask = _pins.data[0] | _pins.data[1] | _pins.data[2] | _pins.data[3];
+  const uint8_t changed = value ^ _value;
+
+  // EN falls first, RS or data changing with it have no hold time
+  if ((changed & _pins.en) && not(value & _pins.en))
+    enable_fall(_value, now);
+
+  if (changed & (_pins.rs | data_mask))
+  {
+    if (now - _fall_at < _timing.hold_ns)
+      violation("hold %llu < %u ns", (unsigned long long)(now - _fall_at), _timing.hold_ns);
+    if (changed & _pins.rs)
+      _rs_at = now;
+    if (changed & data_mask)
+      _data_at = now;
+  }
+
+  if ((changed & _pins.en) && (value & _pins.en))
+  {
+    if (now - _rs_at < _timing.rs_setup_ns)
+      violation("RS setup %llu < %u ns", (unsigned long long)(now - _rs_at),
+                _timing.rs_setup_ns);
+    _en_at = now;
+  }
+
+  if (_pins.bl)
+    _backlight = (value & _pins.bl) != 0;
+  _value = value;
+}
+
+std::string HD44780Model::text(uint8_t row) const
+{
+  std::string line;
+  const uint8_t offset = _geometry.addr(row, 0);
+  for (uint8_t c = 0; c < _geometry.cols; ++c)
+  {
+    uint8_t col = ((offset & 0x3f) + c + _shift) % LCD_DDRAM_LINE_COLS;
+    line.push_back(static_cast<char>(_ddram[offset >> 6 & 0x01][col]));
+  }
+  return line;
+}
+
+uint8_t HD44780Model::ddram(uint8_t addr) const
+{
+  uint8_t col = addr & 0x3f;
+  return col < LCD_DDRAM_LINE_COLS ? _ddram[addr >> 6 & 0x01][col] : ' ';
+}
+
+void HD44780Model::enable_fall(uint8_t value, uint64_t now)
+{
+  if (now - _en_at < _timing.en_high_ns)
+    violation("EN high %llu < %u ns", (unsigned long long)(now - _en_at), _timing.en_high_ns);
+  if (now - _data_at < _timing.setup_ns || now - _rs_at < _timing.setup_ns)
+    violation("data setup < %u ns", _timing.setup_ns);
+  if (_fall_at && now - _fall_at < _timing.cycle_ns)
+    violation("EN cycle %llu < %u ns", (unsigned long long)(now - _fall_at), _timing.cycle_ns);
+  if (now < _busy_until)
+    violation("busy for %llu ns", (unsigned long long)(_busy_until - now));
+  _fall_at = now;
+  _en_at = now;
+
+  uint8_t nibble = 0;
+  for (int32_t b = 0; b < 4; ++b)
+    nibble |= (value & _pins.data[b]) ? 1 << b : 0;
+  bool rs = (value & _pins.rs) != 0;
+
+  // in 8bit mode D3 ~ D0 are not wired and read as 0
+  if (not _four_bit)
+  {
+    execute(rs, nibble << 4, now);
+    return;
+  }
+  if (not _low_nibble)
+  {
+    _high = nibble;
+    _low_nibble = true;
+    return;
+  }
+  _low_nibble = false;
+  execute(rs, (_high << 4) | nibble, now);
+}
+
+void HD44780Model::execute(bool rs, uint8_t byte, uint64_t now)
+{
+  _busy_until = now + _timing.exec_ns;
+  if (rs)
+    write(byte);
+  else
+    instruction(byte, now);
+}
+
+void HD44780Model::instruction(uint8_t cmd, uint64_t now)
+{
+  if (cmd & HD44780_LCD_CMD_DDRAMADDR)
+  {
+    _ac = cmd & 0x7f;
+    _ac_cgram = false;
+  }
+  else if (cmd & HD44780_LCD_CMD_CGRAMADDR)
+  {
+    _ac = cmd & 0x3f;
+    _ac_cgram = true;
+  }
+  else if (cmd & HD44780_LCD_CMD_FUNCSET)
+  {
+    bool eight = (cmd & HD44780_LCD_FUNCSET_8BIT) != 0;
+    if (eight && not _four_bit)
+    {
+      _resets++;
+      if (_resets == 1)
+        _busy_until = now + HD44780_RESET1_NS;
+      else if (_resets == 2)
+        _busy_until = now + HD44780_RESET2_NS;
+    }
+    _four_bit = not eight;
+    _low_nibble = false;
+  }
+  else if (cmd & HD44780_LCD_CMD_CURSOR)
+  {
+    bool right = (cmd & HD44780_LCD_CURSOR_RIGHT) != 0;
+    if (cmd & HD44780_LCD_CURSOR_SHIFT_DIS)
+      _shift = (_shift + (right ? LCD_DDRAM_LINE_COLS - 1 : 1)) % LCD_DDRAM_LINE_COLS;
+    else
+    {
+      bool increment = _increment;
+      _increment = right;
+      advance();
+      _increment = increment;
+    }
+  }
+  else if (cmd & HD44780_LCD_CMD_DISPLAY)
+  {
+    _display = (cmd & HD44780_LCD_DISPLAY_ON) != 0;
+    _cursor = (cmd & HD44780_LCD_DISPLAY_CUR) != 0;
+    _blink = (cmd & HD44780_LCD_DISPLAY_BLINK) != 0;
+  }
+  else if (cmd & HD44780_LCD_CMD_ENTRY)
+  {
+    _increment = (cmd & HD44780_LCD_ENTRY_INC) != 0;
+    _entry_shift = (cmd & HD44780_LCD_ENTRY_SHIFT) != 0;
+  }
+  else if (cmd & (HD44780_LCD_CMD_RETHOME | HD44780_LCD_CMD_CLEAR))
+  {
+    if (cmd == HD44780_LCD_CMD_CLEAR)
+    {
+      memset(_ddram, ' ', sizeof(_ddram));
+      _increment = true;
+    }
+    _ac = 0;
+    _ac_cgram = false;
+    _shift = 0;
+    _busy_until = now + _timing.home_ns;
+  }
+}
+
+void HD44780Model::write(uint8_t data)
+{
+  if (_ac_cgram)
+    _cgram[_ac & 0x3f] = data;
+  else if ((_ac & 0x3f) < LCD_DDRAM_LINE_COLS)
+    _ddram[_ac >> 6 & 0x01][_ac & 0x3f] = data;
+  advance();
+
+  if (_entry_shift && not _ac_cgram)
+    _shift = (_shift + (_increment ? 1 : LCD_DDRAM_LINE_COLS - 1)) % LCD_DDRAM_LINE_COLS;
+}
+
+void HD44780Model::advance(void)
+{
+  if (_ac_cgram)
+  {
+    _ac = (_ac + (_increment ? 1 : 0x3f)) & 0x3f;
+    return;
+  }
+
+  // end of a line continues to the start of the other line
+  uint8_t line = _ac & LCD_DDRAM_LINE1;
+  uint8_t col = _ac & 0x3f;
+  if (_increment)
+    _ac = col + 1 < LCD_DDRAM_LINE_COLS ? line | (col + 1) : line ^ LCD_DDRAM_LINE1;
+  else
+    _ac = col > 0 ? line | (col - 1) : (line ^ LCD_DDRAM_LINE1) | (LCD_DDRAM_LINE_COLS - 1);
+}
+
+} // namespace ft232gpio
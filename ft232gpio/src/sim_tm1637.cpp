@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/sim_tm1637.h"
+
+namespace ft232gpio
+{
+
+TM1637Model::TM1637Model(uint8_t clock, uint8_t dio, const SimBusTiming &timing)
+  : SimTwoWire(clock, dio, timing, true)
+{
+  //
+}
+
+void TM1637Model::on_start(void)
+{
+  //
+  _index = 0;
+}
+
+void TM1637Model::on_byte(uint8_t byte)
+{
+  if (_index++ > 0)
+  {
+    // data after an address command, others take no data
+    if ((_command & 0xC0) != TM1637_CMD_ADDR || _reading)
+      return;
+    if (_addr < TM1637_DIGITS_MAX)
+      _segments[_addr] = byte;
+    else
+      violation("segment address C%XH", _addr);
+    if (not _fixed)
+      _addr++;
+    return;
+  }
+
+  _command = byte;
+  _commands++;
+  switch (byte & 0xC0)
+  {
+  case TM1637_CMD_DATA:
+    _reading = (byte & TM1637_DATA_READ) != 0;
+    _fixed = (byte & TM1637_DATA_FIXADDR) != 0;
+    break;
+  case TM1637_CMD_DISPLAY:
+    _display = (byte & TM1637_DISPLAY_ON) != 0;
+    _pulse = byte & 0x07;
+    break;
+  case TM1637_CMD_ADDR:
+    _addr = byte & 0x0F;
+    break;
+  default:
+    violation("unknown command 0x%02X", byte);
+    break;
+  }
+}
+
+} // namespace ft232gpio
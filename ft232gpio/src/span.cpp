@@ -0,0 +1,205 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/span.h"
+#include "ft232gpio/log.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ft232gpio
+{
+
+struct SpanRecord
+{
+  const char *name;
+  int64_t begin; // ns since the first span of the process
+  int64_t end;
+};
+
+// buffer of one thread. the owner appends under the lock, which only
+// export and clear contend for
+struct SpanThread
+{
+  std::mutex mutex;
+  std::vector<SpanRecord> records;
+  uint64_t dropped = 0;
+  uint32_t tid = 0;
+  std::string name;
+};
+
+namespace
+{
+
+class SpanRegistry
+{
+public:
+  SpanRegistry() : _start(std::chrono::steady_clock::now()) {}
+
+public:
+  int64_t now(void) const
+  {
+    auto elapsed = std::chrono::steady_clock::now() - _start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  }
+
+  // buffers outlive their threads so spans of finished threads are exported
+  std::shared_ptr<SpanThread> add(void)
+  {
+    auto thread = std::make_shared<SpanThread>();
+    thread->records.reserve(SPAN_THREAD_CAPACITY);
+    std::lock_guard<std::mutex> lock(_mutex);
+    thread->tid = ++_tid;
+    _threads.push_back(thread);
+    return thread;
+  }
+
+  std::vector<std::shared_ptr<SpanThread>> threads(void)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _threads;
+  }
+
+private:
+  std::chrono::steady_clock::time_point _start;
+  std::mutex _mutex;
+  std::vector<std::shared_ptr<SpanThread>> _threads;
+  uint32_t _tid = 0;
+};
+
+SpanRegistry &registry(void)
+{
+  static SpanRegistry _registry;
+  return _registry;
+}
+
+SpanThread *this_thread(void)
+{
+  thread_local std::shared_ptr<SpanThread> _thread = registry().add();
+  return _thread.get();
+}
+
+void write_string(FILE *file, const char *text)
+{
+  fputc('"', file);
+  for (const char *p = text; *p; ++p)
+  {
+    if (*p == '"' || *p == '\\')
+      fputc('\\', file);
+    if (uint8_t(*p) >= 0x20)
+      fputc(*p, file);
+  }
+  fputc('"', file);
+}
+
+} // namespace
+
+void Span::begin(const char *name)
+{
+  _thread = this_thread();
+  _name = name;
+  _begin = registry().now();
+}
+
+void Span::end(void)
+{
+  int64_t end = registry().now();
+
+  std::lock_guard<std::mutex> lock(_thread->mutex);
+  if (_thread->records.size() < SPAN_THREAD_CAPACITY)
+    _thread->records.push_back({_name, _begin, end});
+  else
+    _thread->dropped++;
+}
+
+void span_thread_name(const char *name)
+{
+  SpanThread *thread = this_thread();
+  std::lock_guard<std::mutex> lock(thread->mutex);
+  thread->name = name;
+}
+
+void span_clear(void)
+{
+  for (auto &thread : registry().threads())
+  {
+    std::lock_guard<std::mutex> lock(thread->mutex);
+    thread->records.clear();
+    thread->dropped = 0;
+  }
+}
+
+uint64_t span_dropped(void)
+{
+  uint64_t dropped = 0;
+  for (auto &thread : registry().threads())
+  {
+    std::lock_guard<std::mutex> lock(thread->mutex);
+    dropped += thread->dropped;
+  }
+  return dropped;
+}
+
+bool span_write_json(const char *path)
+{
+  FILE *file = fopen(path, "w");
+  if (file == nullptr)
+  {
+    FT232GPIO_ERROR("span_write_json: cannot open %s", path);
+    return false;
+  }
+
+  // complete events, ts and dur in usecs. viewers nest them by time
+  const char *sep = "\n";
+  fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  for (auto &thread : registry().threads())
+  {
+    std::lock_guard<std::mutex> lock(thread->mutex);
+    if (not thread->name.empty())
+    {
+      fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,", sep,
+              thread->tid);
+      fprintf(file, "\"args\":{\"name\":");
+      write_string(file, thread->name.c_str());
+      fprintf(file, "}}");
+      sep = ",\n";
+    }
+    for (auto &record : thread->records)
+    {
+      fprintf(file, "%s{\"name\":", sep);
+      write_string(file, record.name);
+      fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%" PRId64 ".%03" PRId64
+                    ",\"dur\":%" PRId64 ".%03" PRId64 "}",
+              thread->tid, record.begin / 1000, record.begin % 1000,
+              (record.end - record.begin) / 1000, (record.end - record.begin) % 1000);
+      sep = ",\n";
+    }
+  }
+  fprintf(file, "\n]}\n");
+
+  bool ok = fclose(file) == 0;
+  if (not ok)
+    FT232GPIO_ERROR("span_write_json: failed to write %s", path);
+  return ok;
+}
+
+} // namespace ft232gpio
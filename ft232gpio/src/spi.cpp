@@ -0,0 +1,156 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ft232gpio/spi.h"
+#include "ft232gpio/log.h"
+
+#include <cassert>
+#include <cstring>
+
+// half of clock period
+#define SPI_DELAY 10
+
+namespace ft232gpio
+{
+
+void SPI::pins(uint8_t cs, uint8_t sck, uint8_t mosi, uint8_t miso)
+{
+  assert(not _initalized);
+  _pin_cs = cs;
+  _pin_sck = sck;
+  _pin_mosi = mosi;
+  _pin_miso = miso;
+}
+
+bool SPI::init(FT232 *ft232, uint8_t mode, bool lsb_first)
+{
+  if (mode > 3)
+  {
+    FT232GPIO_ERROR("SPI invalid mode %u", mode);
+    return false;
+  }
+
+  _ft232 = ft232;
+  _cpol = (mode & 0x02) != 0;
+  _cpha = (mode & 0x01) != 0;
+  _lsb_first = lsb_first;
+  _initalized = true;
+
+  if (_pin_miso)
+    _ft232->inputs(_ft232->inputs() | _pin_miso);
+
+  // deselect with clock at idle level
+  FT232Batch batch(_ft232);
+  _ft232->write_pins(pin_mask(), idle());
+  _ft232->delay(SPI_DELAY);
+
+  return batch.end();
+}
+
+void SPI::release(void)
+{
+  if (_ft232 == nullptr)
+  {
+    assert(false);
+    return;
+  }
+
+  _ft232->write_pins(pin_mask(), idle());
+  if (_pin_miso)
+    _ft232->inputs(_ft232->inputs() & ~_pin_miso);
+
+  _initalized = false;
+  _ft232 = nullptr;
+}
+
+bool SPI::transfer(const uint8_t *out, uint8_t *in, int32_t length)
+{
+  if (not _initalized)
+  {
+    assert(false);
+    return false;
+  }
+
+  FT232Batch batch(_ft232);
+
+  // CPHA 0: MOSI is set with clock at idle, both sides sample at leading edge
+  // CPHA 1: MOSI is set at leading edge, both sides sample at trailing edge
+  // MISO is read from the last sample before the sampling edge
+  const uint32_t half = _ft232->samples(SPI_DELAY);
+  const uint8_t base = _ft232->port() & ~pin_mask();
+  const uint8_t select = base | (_cpol ? _pin_sck : 0);
+
+  _out.clear();
+  _reads.clear();
+  _out.insert(_out.end(), half, select);
+  for (int32_t i = 0; i < length; ++i)
+  {
+    for (int32_t b = 0; b < 8; ++b)
+    {
+      bool bit = _lsb_first ? (out[i] >> b) & 1 : (out[i] >> (7 - b)) & 1;
+      uint8_t rest = select | (bit ? _pin_mosi : 0);
+      uint8_t lead = rest ^ _pin_sck;
+
+      _out.insert(_out.end(), half, _cpha ? lead : rest);
+      if (_cpha)
+        _reads.push_back(_out.size() - 1);
+      _out.insert(_out.end(), half, _cpha ? rest : lead);
+      if (not _cpha)
+        _reads.push_back(_out.size() - 1);
+    }
+  }
+  _out.insert(_out.end(), half, select);
+  _out.push_back(base | idle());
+
+  if (_pin_miso == 0)
+  {
+    if (in)
+      memset(in, 0xff, length);
+    return _ft232->write_data(_out.data(), _out.size()) && batch.end();
+  }
+
+  _in.resize(_out.size());
+  if (not _ft232->transfer(_out.data(), _in.data(), _out.size(), 0xFF & ~_pin_miso))
+    return false;
+
+  if (in)
+  {
+    for (int32_t i = 0; i < length; ++i)
+    {
+      uint8_t data = 0;
+      for (int32_t b = 0; b < 8; ++b)
+      {
+        bool bit = (_in[_reads[i * 8 + b]] & _pin_miso) != 0;
+        data |= (bit ? 1 : 0) << (_lsb_first ? b : 7 - b);
+      }
+      in[i] = data;
+    }
+  }
+  return batch.end();
+}
+
+//
+// SPI privates
+//
+
+uint8_t SPI::idle(void) const
+{
+  // chip select high, clock at CPOL level, MOSI low
+  uint8_t data = _pin_cs | (_cpol ? _pin_sck : 0);
+  return data;
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,325 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/ssd1306.h"
+#include "ft232gpio/font5x7.h"
+#include "ft232gpio/log.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+namespace ft232gpio
+{
+
+SSD1306::SSD1306(int32_t height)
+{
+  _pages = height > 32 ? SSD1306_PAGES_MAX : SSD1306_PAGES_MAX / 2;
+  memset(_frame, 0, sizeof(_frame));
+  memset(_panel, 0, sizeof(_panel));
+  memset(_dirty_lo, SSD1306_WIDTH, sizeof(_dirty_lo));
+  memset(_dirty_hi, 0, sizeof(_dirty_hi));
+}
+
+bool SSD1306::init(I2C *i2c)
+{
+  FT232GPIO_DEBUG("SSD1306::init %dx%d", width(), height());
+
+  _i2c = i2c;
+  _replay.add(_i2c->ft232(), [this] { replay(); });
+
+  FT232Batch batch(_i2c->ft232());
+
+  _display = true;
+  setup();
+  _initalized = true;
+
+  // GDDRAM is random after power on
+  _panel_valid = false;
+  dirty_all();
+  present();
+
+  return batch.end();
+}
+
+void SSD1306::release(void)
+{
+  if (_i2c == nullptr)
+  {
+    assert(false);
+    return;
+  }
+  _replay.remove();
+
+  display(false);
+
+  _i2c = nullptr;
+  _initalized = false;
+}
+
+void SSD1306::clear(void)
+{
+  //
+  rect(0, 0, width(), height(), true, false);
+}
+
+void SSD1306::pixel(int32_t x, int32_t y, bool on)
+{
+  if (x < 0 || x >= width() || y < 0 || y >= height())
+    return;
+
+  uint8_t &b = _frame[y >> 3][x];
+  uint8_t bit = 1 << (y & 7);
+  uint8_t value = on ? b | bit : b & ~bit;
+  if (value == b)
+    return;
+
+  b = value;
+  dirty(y >> 3, x);
+}
+
+bool SSD1306::pixel(int32_t x, int32_t y) const
+{
+  if (x < 0 || x >= width() || y < 0 || y >= height())
+    return false;
+  return (_frame[y >> 3][x] >> (y & 7)) & 1;
+}
+
+void SSD1306::line(int32_t x0, int32_t y0, int32_t x1, int32_t y1, bool on)
+{
+  // Bresenham, all octants
+  int32_t dx = abs(x1 - x0);
+  int32_t dy = -abs(y1 - y0);
+  int32_t sx = x0 < x1 ? 1 : -1;
+  int32_t sy = y0 < y1 ? 1 : -1;
+  int32_t err = dx + dy;
+
+  while (true)
+  {
+    pixel(x0, y0, on);
+    if (x0 == x1 && y0 == y1)
+      break;
+    int32_t e2 = 2 * err;
+    if (e2 >= dy)
+    {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx)
+    {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+void SSD1306::rect(int32_t x, int32_t y, int32_t w, int32_t h, bool fill, bool on)
+{
+  if (w <= 0 || h <= 0)
+    return;
+
+  if (not fill)
+  {
+    line(x, y, x + w - 1, y, on);
+    line(x, y + h - 1, x + w - 1, y + h - 1, on);
+    line(x, y, x, y + h - 1, on);
+    line(x + w - 1, y, x + w - 1, y + h - 1, on);
+    return;
+  }
+
+  for (int32_t r = y; r < y + h; ++r)
+    for (int32_t c = x; c < x + w; ++c)
+      pixel(c, r, on);
+}
+
+void SSD1306::text(int32_t x, int32_t y, const char *str, bool on)
+{
+  for (; *str != '\x0'; ++str, x += FONT5X7_WIDTH + 1)
+  {
+    const uint8_t *glyph = font5x7_glyph(*str);
+    for (int32_t c = 0; c < FONT5X7_WIDTH + 1; ++c)
+    {
+      uint8_t bits = c < FONT5X7_WIDTH ? glyph[c] : 0x00;
+      for (int32_t r = 0; r < 8; ++r)
+        pixel(x + c, y + r, ((bits >> r) & 1) == on);
+    }
+  }
+}
+
+void SSD1306::present(void)
+{
+  if (not _initalized)
+  {
+    assert(false);
+    return;
+  }
+
+  FT232Batch batch(_i2c->ft232());
+
+  _present_bytes = 0;
+
+  int32_t page = 0;
+  while (page < _pages)
+  {
+    if (not trim(page))
+    {
+      page++;
+      continue;
+    }
+
+    // take in the next dirty page while the clean columns it adds to the
+    // window cost less than a window of its own
+    int32_t first = page;
+    int32_t last = page;
+    int32_t lo = _dirty_lo[page];
+    int32_t hi = _dirty_hi[page];
+    for (int32_t next = page + 1; next < _pages && trim(next); ++next)
+    {
+      int32_t nlo = lo < _dirty_lo[next] ? lo : _dirty_lo[next];
+      int32_t nhi = hi > _dirty_hi[next] ? hi : _dirty_hi[next];
+      int32_t merged = (nhi - nlo) * (next - first + 1);
+      int32_t apart = (hi - lo) * (last - first + 1) + SSD1306_WINDOW_BYTES +
+                      (_dirty_hi[next] - _dirty_lo[next]);
+      if (merged > apart)
+        break;
+      lo = nlo;
+      hi = nhi;
+      last = next;
+    }
+
+    window(first, last, lo, hi);
+    page = last + 1;
+  }
+
+  _panel_valid = true;
+}
+
+void SSD1306::contrast(uint8_t value)
+{
+  FT232Batch batch(_i2c->ft232());
+
+  _contrast = value;
+  uint8_t cmds[] = {SSD1306_CMD_CONTRAST, _contrast};
+  command(cmds, sizeof(cmds));
+}
+
+void SSD1306::display(bool enable)
+{
+  FT232Batch batch(_i2c->ft232());
+
+  _display = enable;
+  uint8_t cmd = _display ? SSD1306_CMD_DISPLAY_ON : SSD1306_CMD_DISPLAY_OFF;
+  command(&cmd, 1);
+}
+
+void SSD1306::setup(void)
+{
+  uint8_t com_pins = _pages == SSD1306_PAGES_MAX ? SSD1306_COM_PINS_64 : SSD1306_COM_PINS_32;
+  uint8_t display = _display ? SSD1306_CMD_DISPLAY_ON : SSD1306_CMD_DISPLAY_OFF;
+
+  // clang-format off
+  uint8_t cmds[] = {
+    SSD1306_CMD_DISPLAY_OFF,
+    SSD1306_CMD_CLOCK_DIV, 0x80,
+    SSD1306_CMD_MULTIPLEX, static_cast<uint8_t>(height() - 1),
+    SSD1306_CMD_OFFSET, 0x00,
+    SSD1306_CMD_START_LINE | 0,
+    SSD1306_CMD_CHARGE_PUMP, SSD1306_CHARGE_PUMP_ON,
+    SSD1306_CMD_ADDR_MODE, SSD1306_ADDR_MODE_HORIZ,
+    SSD1306_CMD_SEG_REMAP,
+    SSD1306_CMD_COM_SCAN_DEC,
+    SSD1306_CMD_COM_PINS, com_pins,
+    SSD1306_CMD_CONTRAST, _contrast,
+    SSD1306_CMD_PRECHARGE, 0xF1,
+    SSD1306_CMD_VCOM_DETECT, 0x40,
+    SSD1306_CMD_RESUME,
+    SSD1306_CMD_NORMAL,
+    display,
+  };
+  // clang-format on
+  command(cmds, sizeof(cmds));
+}
+
+void SSD1306::command(const uint8_t *cmds, uint32_t count)
+{
+  _i2c->write_byte(true, false, SSD1306_CTRL_CMD);
+  for (uint32_t i = 0; i < count; ++i)
+    _i2c->write_byte(false, i + 1 == count, cmds[i]);
+}
+
+void SSD1306::window(int32_t first, int32_t last, int32_t lo, int32_t hi)
+{
+  // horizontal addressing wraps to the next page inside the window, so the
+  // pages go out in one data write
+  uint8_t cmds[] = {
+    SSD1306_CMD_COLUMN_ADDR, static_cast<uint8_t>(lo), static_cast<uint8_t>(hi - 1),
+    SSD1306_CMD_PAGE_ADDR, static_cast<uint8_t>(first), static_cast<uint8_t>(last),
+  };
+  command(cmds, sizeof(cmds));
+
+  _i2c->write_byte(true, false, SSD1306_CTRL_DATA);
+  for (int32_t page = first; page <= last; ++page)
+  {
+    for (int32_t x = lo; x < hi; ++x)
+      _i2c->write_byte(false, page == last && x + 1 == hi, _frame[page][x]);
+
+    memcpy(&_panel[page][lo], &_frame[page][lo], hi - lo);
+    _dirty_lo[page] = SSD1306_WIDTH;
+    _dirty_hi[page] = 0;
+  }
+  _present_bytes += SSD1306_WINDOW_BYTES + (last - first + 1) * (hi - lo);
+}
+
+void SSD1306::dirty(int32_t page, int32_t x)
+{
+  if (x < _dirty_lo[page])
+    _dirty_lo[page] = x;
+  if (x + 1 > _dirty_hi[page])
+    _dirty_hi[page] = x + 1;
+}
+
+void SSD1306::dirty_all(void)
+{
+  memset(_dirty_lo, 0, sizeof(_dirty_lo));
+  memset(_dirty_hi, SSD1306_WIDTH, sizeof(_dirty_hi));
+}
+
+bool SSD1306::trim(int32_t page)
+{
+  // columns drawn and drawn back are the same as the panel
+  if (_panel_valid)
+  {
+    while (_dirty_lo[page] < _dirty_hi[page] &&
+           _frame[page][_dirty_lo[page]] == _panel[page][_dirty_lo[page]])
+      _dirty_lo[page]++;
+    while (_dirty_lo[page] < _dirty_hi[page] &&
+           _frame[page][_dirty_hi[page] - 1] == _panel[page][_dirty_hi[page] - 1])
+      _dirty_hi[page]--;
+  }
+  return _dirty_lo[page] < _dirty_hi[page];
+}
+
+void SSD1306::replay(void)
+{
+  // panel may have been power cycled with the adapter
+  setup();
+  _panel_valid = false;
+  dirty_all();
+  present();
+}
+
+} // namespace ft232gpio
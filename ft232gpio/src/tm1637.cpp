@@ -15,29 +15,47 @@
  */
 
 #include "ft232gpio/tm1637.h"
+#include "ft232gpio/log.h"
+#include "ft232gpio/profile.h"
+#include "ft232gpio/span.h"
 
-#include <iostream>
-#include <bitset>
+#include <algorithm>
 #include <cassert>
-
-#include <unistd.h> // usleep
+#include <chrono>
+#include <vector>
 
 // NOTE TM1637 CLK/DIO is like I2C but quite different
 
-#define PIN_CLOCK 0x08 // CTS of FT232
-#define PIN_DIO 0x10   // DTR of FT232
-
-static const uint32_t CLOCK_DELAY = 20;
-static const uint32_t DATA_DELAY = 20;
+// bus cost in clocks, start and stop take one each and a byte with ack nine
+static int32_t transaction_bits(int32_t bytes) { return 2 + 9 * bytes; }
 
 namespace ft232gpio
 {
 
+void TM1637::pins(uint8_t clock, uint8_t dio)
+{
+  assert(not _initalized);
+  _pin_clock = clock;
+  _pin_dio = dio;
+}
+
 bool TM1637::init(FT232 *ft232)
 {
+  FT232GPIO_SPAN("TM1637::init");
+
+  auto start = std::chrono::steady_clock::now();
+
   _ft232 = ft232;
   _initalized = true;
 
+  _timing = TM1637_TIMING_DEFAULT;
+  timing_profiles().lookup(_ft232->serial(), pin_mask(), _timing);
+
+  _replay.add(_ft232, [this] { replay(); });
+  _segments_valid = false;
+
+  FT232Batch batch(_ft232);
+
   // initialize chip
   uint8_t command;
   command = TM1637_CMD_DATA | TM1637_DATA_AUTOINC | TM1637_DATA_NORMAL;
@@ -49,7 +67,39 @@ bool TM1637::init(FT232 *ft232)
   // set default bright to 1
   bright(1);
 
-  return true;
+  bool ok = batch.end();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  _init_usecs = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+
+  return ok;
+}
+
+bool TM1637::attach(FT232 *ft232, uint8_t value)
+{
+  FT232GPIO_SPAN("TM1637::attach");
+
+  auto start = std::chrono::steady_clock::now();
+
+  _ft232 = ft232;
+  _initalized = true;
+
+  _timing = TM1637_TIMING_DEFAULT;
+  timing_profiles().lookup(_ft232->serial(), pin_mask(), _timing);
+
+  _replay.add(_ft232, [this] { replay(); });
+  _segments_valid = false; // contents are not known, first update sends all
+
+  // segment registers keep their contents, only modes are sent again
+  FT232Batch batch(_ft232);
+  command(TM1637_CMD_DATA | TM1637_DATA_AUTOINC | TM1637_DATA_NORMAL);
+  command(bright_command(value));
+
+  bool ok = batch.end();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  _init_usecs = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  FT232GPIO_INFO("TM1637::attach %uus", _init_usecs);
+
+  return ok;
 }
 
 void TM1637::release(void)
@@ -62,6 +112,7 @@ void TM1637::release(void)
 
   bright(0);
 
+  _replay.remove();
   _initalized = false;
 
   _ft232 = nullptr;
@@ -69,32 +120,46 @@ void TM1637::release(void)
 
 void TM1637::write(uint8_t data)
 {
+  FT232GPIO_SPAN("TM1637::write");
+
   if (not _initalized)
   {
     assert(false);
     return;
   }
 
-  std::cout << "tm1637 write " << std::bitset<8>(data) << std::endl;
-
-  dio_start();
-
-  write_byte(data);
-  skip_ack();
+  FT232GPIO_TRACE("tm1637 write 0x%02x", data);
 
-  dio_stop();
+  FT232Batch batch(_ft232);
+  command(data);
 
-  usleep(1000);
+  _ft232->delay(1000);
 }
 
 void TM1637::writes(uint8_t *data, int32_t length)
 {
+  FT232GPIO_SPAN("TM1637::writes");
+
   if (not _initalized)
   {
     assert(false);
     return;
   }
 
+  FT232Batch batch(_ft232);
+
+  // keep segment registers written with address command
+  if (length > 0 && (data[0] & 0xc0) == TM1637_CMD_ADDR)
+  {
+    uint8_t addr = data[0] & 0x0f;
+    bool fixed = (_data_cmd & TM1637_DATA_FIXADDR) != 0;
+    for (int32_t b = 1; b < length && addr < TM1637_DIGITS_MAX; b++)
+    {
+      _segments[addr] = data[b];
+      addr += fixed ? 0 : 1;
+    }
+  }
+
   dio_start();
 
   for (int b = 0; b < length; b++)
@@ -110,97 +175,366 @@ void TM1637::writes(uint8_t *data, int32_t length)
 // value 1 ~ 7 for display on and brighness value
 void TM1637::bright(uint8_t value)
 {
+  FT232GPIO_SPAN("TM1637::bright");
+
   if (not _initalized)
   {
     assert(false);
     return;
   }
 
-  uint8_t command;
+  write(bright_command(value));
+}
 
-  if (value == 0) // display off
-    command = TM1637_CMD_DISPLAY | TM1637_DISPLAY_OFF;
+void TM1637::clear(void)
+{
+  FT232GPIO_SPAN("TM1637::clear");
+
+  uint8_t segdata[TM1637_DIGITS_MAX] = {0};
+
+  update(segdata);
+}
+
+void TM1637::test(void)
+{
+  uint8_t segdata[TM1637_DIGITS_MAX] = {0};
+
+  segdata[0] = 0b00111111;
+  segdata[1] = 0b00000110 | TM1637_DBIT_COLON;
+  segdata[2] = 0b01011011;
+  segdata[3] = 0b01001111;
+
+  update(segdata);
+}
+
+void TM1637::digits(uint8_t data[4], bool colon)
+{
+  FT232GPIO_SPAN("TM1637::digits");
+
+  uint8_t segdata[TM1637_DIGITS_MAX] = {0};
+
+  FT232Batch batch(_ft232);
+  for (int32_t d = 0; d < _digits; ++d)
+    segdata[d] = d < 4 ? data[d] : _segments[d];
+  segdata[1] |= colon ? TM1637_DBIT_COLON : 0;
+
+  update(segdata);
+}
+
+void TM1637::update(const uint8_t *data)
+{
+  FT232GPIO_SPAN("TM1637::update");
+
+  if (not _initalized)
+  {
+    assert(false);
+    return;
+  }
+
+  FT232Batch batch(_ft232);
+
+  bool changed[TM1637_DIGITS_MAX] = {false};
+  int32_t count = 0;
+  for (int32_t d = 0; d < _digits; ++d)
+  {
+    changed[d] = not _segments_valid || data[d] != _segments[d];
+    count += changed[d] ? 1 : 0;
+  }
+  if (count == 0)
+    return;
+
+  // auto increment runs, resending one unchanged digit is cheaper than
+  // starting another transaction with an address
+  int32_t runs[TM1637_DIGITS_MAX][2];
+  int32_t nruns = 0;
+  int32_t auto_bits = 0;
+  for (int32_t d = 0; d < _digits; ++d)
+  {
+    if (not changed[d])
+      continue;
+    if (nruns > 0 && d - runs[nruns - 1][1] <= 2)
+      runs[nruns - 1][1] = d;
+    else
+    {
+      runs[nruns][0] = runs[nruns][1] = d;
+      nruns++;
+    }
+  }
+  for (int32_t r = 0; r < nruns; ++r)
+    auto_bits += transaction_bits(2 + runs[r][1] - runs[r][0]);
+
+  // fixed address, one address and one data byte per changed digit
+  int32_t fixed_bits = count * transaction_bits(2);
+
+  // changing data mode takes one more command
+  const uint8_t mode_auto = TM1637_CMD_DATA | TM1637_DATA_AUTOINC | TM1637_DATA_NORMAL;
+  const uint8_t mode_fixed = TM1637_CMD_DATA | TM1637_DATA_FIXADDR | TM1637_DATA_NORMAL;
+  auto_bits += _data_cmd == mode_auto ? 0 : transaction_bits(1);
+  fixed_bits += _data_cmd == mode_fixed ? 0 : transaction_bits(1);
+
+  uint8_t segdata[1 + TM1637_DIGITS_MAX];
+  if (fixed_bits < auto_bits)
+  {
+    data_mode(mode_fixed);
+    for (int32_t d = 0; d < _digits; ++d)
+    {
+      if (not changed[d])
+        continue;
+      segdata[0] = TM1637_CMD_ADDR | d;
+      segdata[1] = data[d];
+      writes(segdata, 2);
+    }
+  }
   else
   {
-    value = value > 8 ? 8 : value;
-    command = TM1637_CMD_DISPLAY | TM1637_DISPLAY_ON;
-    command |= (value - 1);
-    // command is pulse width for brighness
-    // 0 :  1/16
-    // 1 :  2/16
-    // 2 :  4/16
-    // 3 : 10/16
-    // 4 : 11/16
-    // 5 : 12/16
-    // 6 : 13/16
-    // 7 : 14/16
+    data_mode(mode_auto);
+    for (int32_t r = 0; r < nruns; ++r)
+    {
+      int32_t length = 0;
+      segdata[length++] = TM1637_CMD_ADDR | runs[r][0];
+      for (int32_t d = runs[r][0]; d <= runs[r][1]; ++d)
+        segdata[length++] = data[d];
+      writes(segdata, length);
+    }
   }
+  _segments_valid = true;
+}
 
-  write(command);
+std::vector<uint8_t> TM1637::encode(const TM1637Frame &frame)
+{
+  FT232GPIO_SPAN("TM1637::encode");
+
+  if (not _initalized)
+  {
+    assert(false);
+    return {};
+  }
+
+  uint8_t segdata[1 + TM1637_DIGITS_MAX];
+  segdata[0] = TM1637_CMD_ADDR | TM1637_ADDR_C0H;
+  for (int32_t d = 0; d < _digits; ++d)
+    segdata[1 + d] = frame.segments[d];
+
+  // recording is not sent, keep the state of the display. the recording
+  // holds the port lock, so show() from another thread sees either state.
+  _ft232->record_begin();
+
+  uint8_t segments[TM1637_DIGITS_MAX];
+  std::copy(_segments, _segments + TM1637_DIGITS_MAX, segments);
+  uint8_t data_cmd = _data_cmd;
+  uint8_t display_cmd = _display_cmd;
+
+  command(TM1637_CMD_DATA | TM1637_DATA_AUTOINC | TM1637_DATA_NORMAL);
+  writes(segdata, 1 + _digits);
+  command(bright_command(frame.bright));
+
+  std::copy(segments, segments + TM1637_DIGITS_MAX, _segments);
+  _data_cmd = data_cmd;
+  _display_cmd = display_cmd;
+
+  auto wave = _ft232->record_end();
+
+  // other pins may change before the wave is shown, show() fills them in
+  for (auto &sample : wave)
+    sample &= pin_mask();
+
+  return wave;
 }
 
-void TM1637::clear(void)
+bool TM1637::show(const std::vector<uint8_t> &wave, const TM1637Frame &frame)
 {
-  int32_t dst;
-  uint8_t segdata[6];
+  FT232GPIO_SPAN("TM1637::show");
+
+  if (not _initalized)
+  {
+    assert(false);
+    return false;
+  }
 
-  dst = 0;
-  segdata[dst++] = TM1637_CMD_ADDR | TM1637_ADDR_C0H;
-  segdata[dst++] = 0;
-  segdata[dst++] = 0;
-  segdata[dst++] = 0;
-  segdata[dst++] = 0;
+  FT232Batch batch(_ft232);
 
-  writes(segdata, dst);
+  std::copy(frame.segments, frame.segments + _digits, _segments);
+  _segments_valid = true;
+  _data_cmd = TM1637_CMD_DATA | TM1637_DATA_AUTOINC | TM1637_DATA_NORMAL;
+  _display_cmd = bright_command(frame.bright);
+
+  // pins of other devices keep their current values
+  const uint8_t base = _ft232->port() & ~pin_mask();
+  _wave.resize(wave.size());
+  for (size_t s = 0; s < wave.size(); ++s)
+    _wave[s] = base | (wave[s] & pin_mask());
+
+  _ft232->write_data(_wave.data(), _wave.size());
+  return batch.end();
 }
 
-void TM1637::test(void)
+uint8_t TM1637::keyscan(void)
 {
-  int32_t dst;
-  uint8_t segdata[6];
+  FT232GPIO_SPAN("TM1637::keyscan");
+
+  if (not _initalized)
+  {
+    assert(false);
+    return TM1637_KEY_NONE;
+  }
+
+  FT232Batch batch(_ft232);
+
+  dio_start();
+  write_byte(TM1637_CMD_DATA | TM1637_DATA_READ);
+  skip_ack();
+  _data_cmd = TM1637_CMD_DATA | TM1637_DATA_READ; // next write sets mode again
+
+  // TM1637 drives DIO with the key code from LSB, stable while clock is high.
+  // DIO is an input for these samples, read the last one of each high clock.
+  // pins of other devices keep their values.
+  const uint32_t hold = _ft232->samples(_timing.clock_usecs);
+  const uint8_t base = _ft232->port() & ~pin_mask();
+  std::vector<uint8_t> out;
+  uint32_t reads[8];
+  for (int i = 0; i < 8; i++)
+  {
+    out.insert(out.end(), hold, base);
+    out.insert(out.end(), hold, base | _pin_clock);
+    reads[i] = out.size() - 1;
+  }
+  std::vector<uint8_t> in(out.size());
+  if (not _ft232->transfer(out.data(), in.data(), out.size(), 0xFF & ~_pin_dio))
+    return TM1637_KEY_NONE;
 
-  dst = 0;
-  segdata[dst++] = TM1637_CMD_ADDR | TM1637_ADDR_C0H;
-  segdata[dst++] = 0b00111111;
-  segdata[dst++] = 0b00000110 | TM1637_DBIT_COLON;
-  segdata[dst++] = 0b01011011;
-  segdata[dst++] = 0b01001111;
+  uint8_t code = 0;
+  for (int i = 0; i < 8; i++)
+    code |= (in[reads[i]] & _pin_dio ? 1 : 0) << i;
 
-  writes(segdata, dst);
+  skip_ack();
+  dio_stop();
+
+  if (not batch.end())
+    return TM1637_KEY_NONE;
+  return code;
 }
 
-void TM1637::digits(uint8_t data[4], bool colon)
+bool TM1637::probe(void)
 {
-  int32_t dst;
-  uint8_t segdata[6];
+  FT232GPIO_SPAN("TM1637::probe");
+
+  if (not _initalized)
+  {
+    assert(false);
+    return false;
+  }
+
+  FT232Batch batch(_ft232);
+
+  dio_start();
+  write_byte(_display_cmd);
 
-  dst = 0;
-  segdata[dst++] = TM1637_CMD_ADDR | TM1637_ADDR_C0H;
-  segdata[dst++] = data[0];
-  segdata[dst++] = data[1] | (colon ? TM1637_DBIT_COLON : 0);
-  segdata[dst++] = data[2];
-  segdata[dst++] = data[3];
+  // acknowledge clock with DIO as input, read at the end of CLK high
+  const uint32_t hold = _ft232->samples(_timing.clock_usecs);
+  const uint8_t base = (_ft232->port() & ~pin_mask()) | _pin_dio;
+  std::vector<uint8_t> out(hold, base);
+  out.insert(out.end(), hold, base | _pin_clock);
+  out.push_back(base);
+  std::vector<uint8_t> in(out.size());
+  bool ok = _ft232->transfer(out.data(), in.data(), out.size(), 0xFF & ~_pin_dio);
 
-  writes(segdata, dst);
+  dio_stop();
+  ok = batch.end() && ok;
+
+  return ok && (in[2 * hold] & _pin_dio) == 0;
+}
+
+int8_t TM1637::key_index(uint8_t code)
+{
+  int8_t sg = 7 - (code & 0x07);
+  if ((code & 0xf8) == 0xf0)
+    return sg; // K1
+  if ((code & 0xf8) == 0xe8)
+    return 8 + sg; // K2
+  return -1;
 }
 
 //
 // TM1637 privates
 //
 
+void TM1637::replay(void)
+{
+  uint8_t segdata[1 + TM1637_DIGITS_MAX];
+
+  segdata[0] = TM1637_CMD_ADDR | TM1637_ADDR_C0H;
+  for (int32_t d = 0; d < TM1637_DIGITS_MAX; ++d)
+    segdata[1 + d] = _segments[d];
+
+  command(TM1637_CMD_DATA | TM1637_DATA_AUTOINC | TM1637_DATA_NORMAL);
+  writes(segdata, 1 + TM1637_DIGITS_MAX);
+  command(_display_cmd);
+}
+
+void TM1637::command(uint8_t data)
+{
+  if ((data & 0xc0) == TM1637_CMD_DISPLAY)
+    _display_cmd = data;
+  if ((data & 0xc0) == TM1637_CMD_DATA)
+    _data_cmd = data;
+
+  FT232Batch batch(_ft232);
+
+  dio_start();
+
+  write_byte(data);
+  skip_ack();
+
+  dio_stop();
+}
+
+void TM1637::data_mode(uint8_t mode)
+{
+  if (_data_cmd != mode)
+    command(mode);
+}
+
+uint8_t TM1637::bright_command(uint8_t value)
+{
+  uint8_t cmd;
+
+  if (value == 0) // display off
+    cmd = TM1637_CMD_DISPLAY | TM1637_DISPLAY_OFF;
+  else
+  {
+    value = value > 8 ? 8 : value;
+    cmd = TM1637_CMD_DISPLAY | TM1637_DISPLAY_ON;
+    cmd |= (value - 1);
+    // command is pulse width for brighness
+    // 0 :  1/16
+    // 1 :  2/16
+    // 2 :  4/16
+    // 3 : 10/16
+    // 4 : 11/16
+    // 5 : 12/16
+    // 6 : 13/16
+    // 7 : 14/16
+  }
+  return cmd;
+}
+
+void TM1637::set_pins(bool clock, bool dio)
+{
+  uint8_t data = (clock ? _pin_clock : 0) | (dio ? _pin_dio : 0);
+  _ft232->write_pins(pin_mask(), data);
+}
+
 void TM1637::dio_start(void)
 {
   // CLK 11
   // DIO 10
 
   // set both high to enter start
-  uint8_t data = PIN_CLOCK | PIN_DIO;
-  _ft232->write_data(&data, 1);
-  usleep(CLOCK_DELAY);
+  set_pins(true, true);
+  _ft232->delay(_timing.clock_usecs);
 
-  data = PIN_CLOCK;
-  _ft232->write_data(&data, 1);
-  usleep(CLOCK_DELAY);
+  set_pins(true, false);
+  _ft232->delay(_timing.clock_usecs);
 }
 
 void TM1637::dio_stop(void)
@@ -208,38 +542,31 @@ void TM1637::dio_stop(void)
   // CLK 0111
   // DIO 0011
 
-  uint8_t data = 0;
-  _ft232->write_data(&data, 1);
-  usleep(CLOCK_DELAY);
+  set_pins(false, false);
+  _ft232->delay(_timing.clock_usecs);
 
-  data = PIN_CLOCK;
-  _ft232->write_data(&data, 1);
-  usleep(CLOCK_DELAY);
-  data = PIN_CLOCK | PIN_DIO;
-  _ft232->write_data(&data, 1);
-  usleep(CLOCK_DELAY);
+  set_pins(true, false);
+  _ft232->delay(_timing.clock_usecs);
+  set_pins(true, true);
+  _ft232->delay(_timing.clock_usecs);
 }
 
 void TM1637::write_byte(uint8_t b)
 {
-  uint8_t data;
   for (int i = 0; i < 8; i++)
   {
     // CLK 001
     // DIO 0bb
 
-    data = 0;
-    _ft232->write_data(&data, 1);
-    usleep(DATA_DELAY);
+    set_pins(false, false);
+    _ft232->delay(_timing.hold_usecs);
 
     // send LSB to MSB
-    data = b & 1 ? PIN_DIO : 0;
-    _ft232->write_data(&data, 1);
-    usleep(CLOCK_DELAY);
+    set_pins(false, b & 1);
+    _ft232->delay(_timing.clock_usecs);
 
-    data |= PIN_CLOCK;
-    _ft232->write_data(&data, 1);
-    usleep(CLOCK_DELAY);
+    set_pins(true, b & 1);
+    _ft232->delay(_timing.clock_usecs);
 
     b >>= 1; // next LSB
   }
@@ -250,17 +577,14 @@ void TM1637::skip_ack(void)
   // CLK 010
   // DIO 111
 
-  uint8_t data = PIN_DIO;
-  _ft232->write_data(&data, 1);
-  usleep(CLOCK_DELAY);
+  set_pins(false, true);
+  _ft232->delay(_timing.clock_usecs);
 
-  data |= PIN_CLOCK;
-  _ft232->write_data(&data, 1);
-  usleep(CLOCK_DELAY);
+  set_pins(true, true);
+  _ft232->delay(_timing.clock_usecs);
 
-  data &= ~PIN_CLOCK;
-  _ft232->write_data(&data, 1);
-  usleep(CLOCK_DELAY);
+  set_pins(false, true);
+  _ft232->delay(_timing.clock_usecs);
 }
 
 } // namespace ft232gpio
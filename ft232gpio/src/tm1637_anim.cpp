@@ -0,0 +1,163 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ft232gpio/tm1637_anim.h"
+#include "ft232gpio/seg7.h"
+#include "ft232gpio/log.h"
+
+#include <cstring>
+
+namespace ft232gpio
+{
+
+TM1637Animation::~TM1637Animation()
+{
+  //
+  stop();
+}
+
+bool TM1637Animation::load(TM1637 *tm1637, const std::vector<TM1637Frame> &frames)
+{
+  if (_running || frames.empty())
+    return false;
+
+  _tm1637 = tm1637;
+  _frames = frames;
+  _waves.clear();
+  size_t bytes = 0;
+  for (auto &frame : _frames)
+  {
+    _waves.push_back(_tm1637->encode(frame));
+    bytes += _waves.back().size();
+  }
+  FT232GPIO_DEBUG("TM1637Animation %zu frames, %zu samples", _frames.size(), bytes);
+  return true;
+}
+
+bool TM1637Animation::start(uint32_t fps, bool loop)
+{
+  if (_running || _waves.empty() || fps == 0)
+    return false;
+
+  _period = std::chrono::nanoseconds(1000000000 / fps);
+  _loop = loop;
+  _shown = 0;
+  _skipped = 0;
+
+  if (_thread.joinable())
+    _thread.join(); // previous one has finished
+  _running = true;
+  _thread = std::thread(&TM1637Animation::run, this);
+  return true;
+}
+
+void TM1637Animation::stop(void)
+{
+  _running = false;
+  if (_thread.joinable())
+    _thread.join();
+}
+
+void TM1637Animation::run(void)
+{
+  const uint64_t count = _frames.size();
+  const auto start = std::chrono::steady_clock::now();
+  uint64_t frame = 0;
+
+  while (_running)
+  {
+    if (not _loop && frame >= count)
+      frame = count - 1; // skipped past the end, finish on the last frame
+
+    auto index = frame % count;
+    _tm1637->show(_waves[index], _frames[index]);
+    _shown++;
+
+    if (not _loop && frame == count - 1)
+      break;
+
+    // frame n is due at start + n * period, drop the frames already late
+    frame++;
+    auto due = start + _period * frame;
+    auto now = std::chrono::steady_clock::now();
+    if (due < now)
+    {
+      uint64_t late = (now - start) / _period;
+      _skipped += late - frame;
+      frame = late;
+      due = start + _period * frame;
+    }
+    std::this_thread::sleep_until(due);
+  }
+  _running = false;
+}
+
+std::vector<TM1637Frame> tm1637_scroll(const char *text, int32_t digits, uint8_t bright)
+{
+  std::vector<TM1637Frame> frames;
+  int32_t length = strlen(text);
+
+  // position p shows text[p - digits] on the first digit
+  for (int32_t p = 0; p <= length + digits; ++p)
+  {
+    TM1637Frame frame{};
+    frame.bright = bright;
+    for (int32_t d = 0; d < digits && d < TM1637_DIGITS_MAX; ++d)
+    {
+      int32_t c = p - digits + d;
+      frame.segments[d] = c >= 0 && c < length ? seg7_char(text[c]) : SEG7_BLANK;
+    }
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+std::vector<TM1637Frame> tm1637_fade(const uint8_t segments[TM1637_DIGITS_MAX], uint8_t from,
+                                     uint8_t to)
+{
+  std::vector<TM1637Frame> frames;
+  int32_t step = from < to ? 1 : -1;
+
+  for (int32_t b = from;; b += step)
+  {
+    TM1637Frame frame;
+    memcpy(frame.segments, segments, TM1637_DIGITS_MAX);
+    frame.bright = b;
+    frames.push_back(frame);
+    if (b == to)
+      break;
+  }
+  return frames;
+}
+
+std::vector<TM1637Frame> tm1637_spinner(int32_t digit, uint8_t bright)
+{
+  static const uint8_t around[] = {SEG7_A, SEG7_B, SEG7_C, SEG7_D, SEG7_E, SEG7_F};
+  std::vector<TM1637Frame> frames;
+  if (digit < 0 || digit >= TM1637_DIGITS_MAX)
+    return frames;
+
+  for (auto seg : around)
+  {
+    TM1637Frame frame{};
+    frame.bright = bright;
+    frame.segments[digit] = seg;
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+} // namespace ft232gpio
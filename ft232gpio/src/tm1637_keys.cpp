@@ -0,0 +1,103 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ft232gpio/tm1637_keys.h"
+#include "ft232gpio/log.h"
+
+namespace ft232gpio
+{
+
+TM1637Keys::~TM1637Keys()
+{
+  //
+  stop();
+}
+
+bool TM1637Keys::start(TM1637 *tm1637, uint32_t interval_ms, uint32_t debounce)
+{
+  if (_running)
+    return false;
+
+  _tm1637 = tm1637;
+  _interval = std::chrono::milliseconds(interval_ms);
+  _debounce = debounce > 0 ? debounce : 1;
+
+  _running = true;
+  _thread = std::thread(&TM1637Keys::run, this);
+  return true;
+}
+
+void TM1637Keys::stop(void)
+{
+  _running = false;
+  if (_thread.joinable())
+    _thread.join();
+}
+
+void TM1637Keys::on_key(std::function<void(const KeyEvent &)> callback)
+{
+  std::lock_guard<std::mutex> lock(_callback_mutex);
+  _callback = std::move(callback);
+}
+
+void TM1637Keys::run(void)
+{
+  int8_t stable = -1;    // accepted key
+  int8_t candidate = -1; // key seen in last scans
+  uint32_t count = 0;
+
+  // absolute schedule, bus time of a scan does not add to the interval
+  auto next = std::chrono::steady_clock::now();
+  while (_running)
+  {
+    int8_t key = TM1637::key_index(_tm1637->keyscan());
+    auto now = std::chrono::steady_clock::now();
+
+    if (key != candidate)
+    {
+      candidate = key;
+      count = 0;
+    }
+    if (++count >= _debounce && candidate != stable)
+    {
+      if (stable >= 0)
+        emit(stable, false, now);
+      stable = candidate;
+      if (stable >= 0)
+        emit(stable, true, now);
+    }
+
+    next += _interval;
+    if (next < now)
+      next = now; // late, skip missed scans
+    std::this_thread::sleep_until(next);
+  }
+}
+
+void TM1637Keys::emit(int8_t key, bool pressed, std::chrono::steady_clock::time_point time)
+{
+  FT232GPIO_DEBUG("TM1637 key %d %s", key, pressed ? "press" : "release");
+
+  KeyEvent event{key, pressed, time};
+
+  std::lock_guard<std::mutex> lock(_callback_mutex);
+  if (_callback)
+    _callback(event);
+  else
+    _queue.push(event);
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/trace.h"
+#include "ft232gpio/vcd.h"
+
+#include <chrono>
+
+namespace ft232gpio
+{
+
+static int64_t steady_nsecs(void)
+{
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+Trace::Trace(size_t capacity) : _ring(capacity > 0 ? capacity : 1)
+{
+  //
+}
+
+void Trace::record(const uint8_t *buf, size_t size, uint32_t sample_rate)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  int64_t now = steady_nsecs();
+  if (not _started)
+  {
+    _start = now;
+    _started = true;
+  }
+
+  // adapter queues the transfer behind the samples it has not sent yet
+  uint64_t at = now - _start;
+  if (at > _next)
+    _stats.idle_nsecs += _stats.samples ? at - _next : 0;
+  else
+    at = _next;
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    _ring[_head] = TraceSample{at + i * 1000000000ull / sample_rate, buf[i]};
+    _head = (_head + 1) % _ring.size();
+    if (_size < _ring.size())
+      _size++;
+    else
+      _stats.dropped++;
+  }
+  _next = at + size * 1000000000ull / sample_rate;
+  _sample_rate = sample_rate;
+
+  _stats.transfers++;
+  _stats.samples += size;
+}
+
+void Trace::clear(void)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  _head = 0;
+  _size = 0;
+  _stats = TraceStats();
+  _started = false;
+  _next = 0;
+}
+
+TraceStats Trace::stats(void)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _stats;
+}
+
+std::vector<TraceSample> Trace::snapshot(void)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  // oldest first
+  std::vector<TraceSample> samples;
+  samples.reserve(_size);
+  size_t first = (_head + _ring.size() - _size) % _ring.size();
+  for (size_t i = 0; i < _size; ++i)
+    samples.push_back(_ring[(first + i) % _ring.size()]);
+  return samples;
+}
+
+bool Trace::write_vcd(const char *path, uint8_t mask, const char *const *names)
+{
+  uint32_t rate;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    rate = _sample_rate;
+  }
+  auto samples = snapshot();
+
+  // time to sample index at the sample rate, gaps between transfers are
+  // indexes without samples, which VCD shows as the port held
+  VCDWriter vcd;
+  if (not vcd.open(path, rate, mask, names))
+    return false;
+  uint64_t index = 0;
+  for (auto &s : samples)
+  {
+    uint64_t at = s.nsecs * rate / 1000000000ull;
+    index = at > index ? at : index; // rounding must not go back
+    vcd.sample(index++, s.value);
+  }
+  vcd.close();
+  return true;
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ft232gpio/tuner.h"
+#include "ft232gpio/log.h"
+
+#include <algorithm>
+
+namespace ft232gpio
+{
+
+bool TimingTuner::tune(const std::vector<TuneParam> &params)
+{
+  std::vector<uint32_t> start;
+  for (auto &param : params)
+    start.push_back(*param.usecs);
+
+  auto restore = [&] {
+    for (size_t i = 0; i < params.size(); ++i)
+      *params[i].usecs = start[i];
+  };
+
+  if (not passes())
+  {
+    FT232GPIO_WARN("TimingTuner fails with the values given");
+    return false;
+  }
+
+  // later values are searched with the earlier ones at their limits
+  std::vector<uint32_t> limits;
+  for (auto &param : params)
+    limits.push_back(limit(param.usecs));
+
+  for (size_t i = 0; i < params.size(); ++i)
+  {
+    uint32_t margin = std::max<uint32_t>(1, uint64_t(limits[i]) * _margin / 100);
+    *params[i].usecs = std::min(start[i], limits[i] + margin);
+    FT232GPIO_INFO("TimingTuner %s %u -> %u (limit %u)", params[i].name, start[i],
+                   *params[i].usecs, limits[i]);
+  }
+
+  if (not passes())
+  {
+    FT232GPIO_WARN("TimingTuner fails with the margin, values restored");
+    restore();
+    return false;
+  }
+  return true;
+}
+
+bool TimingTuner::passes(void)
+{
+  for (uint32_t r = 0; r < _repeat; ++r)
+  {
+    _checks++;
+    if (not _check())
+      return false;
+  }
+  return true;
+}
+
+uint32_t TimingTuner::limit(uint32_t *usecs)
+{
+  uint32_t good = *usecs;
+  uint32_t bad = good;
+
+  // halve while it passes
+  while (good > 0)
+  {
+    *usecs = good / 2;
+    if (not passes())
+    {
+      bad = good / 2;
+      break;
+    }
+    good = good / 2;
+  }
+
+  // bad < good here unless good reached 0
+  while (good > 0 && good - bad > 1)
+  {
+    uint32_t mid = bad + (good - bad) / 2;
+    *usecs = mid;
+    if (passes())
+      good = mid;
+    else
+      bad = mid;
+  }
+
+  *usecs = good;
+  return good;
+}
+
+} // namespace ft232gpio
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2024 saehie.park@gmail.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ft232gpio/vcd.h"
+#include "ft232gpio/log.h"
+
+#include <ctime>
+
+namespace ft232gpio
+{
+
+const char *const VCD_PIN_NAMES[8] = {"TXD", "RXD", "RTS", "CTS", "DTR", "DSR", "DCD", "RI"};
+
+// identifier of pin n in VCD is a printable character
+static char vcd_id(int32_t pin) { return '!' + pin; }
+
+VCDWriter::~VCDWriter()
+{
+  //
+  close();
+}
+
+bool VCDWriter::open(const char *path, uint32_t sample_rate, uint8_t mask,
+                     const char *const *names)
+{
+  if (_file)
+    close();
+
+  _file = fopen(path, "w");
+  if (_file == nullptr)
+  {
+    FT232GPIO_ERROR("VCD open failed: %s", path);
+    return false;
+  }
+  _sample_rate = sample_rate;
+  _mask = mask;
+  _first = true;
+  _end = 0;
+  names = names ? names : VCD_PIN_NAMES;
+
+  std::time_t now = std::time(nullptr);
+  char date[64];
+  std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+
+  fprintf(_file, "$date %s $end\n", date);
+  fprintf(_file, "$version ft232gpio $end\n");
+  fprintf(_file, "$timescale 1ns $end\n");
+  fprintf(_file, "$scope module ft232 $end\n");
+  for (int32_t pin = 0; pin < 8; ++pin)
+  {
+    if (_mask & (1 << pin))
+      fprintf(_file, "$var wire 1 %c %s $end\n", vcd_id(pin), names[pin]);
+  }
+  fprintf(_file, "$upscope $end\n");
+  fprintf(_file, "$enddefinitions $end\n");
+  return true;
+}
+
+void VCDWriter::close(void)
+{
+  if (_file == nullptr)
+    return;
+
+  // time of the end so the last values have a length
+  fprintf(_file, "#%llu\n", (unsigned long long)(_end * 1000000000ull / _sample_rate));
+  fclose(_file);
+  _file = nullptr;
+}
+
+void VCDWriter::sample(uint64_t index, uint8_t value)
+{
+  if (_file == nullptr)
+    return;
+
+  if (_first || ((value ^ _last) & _mask))
+    change(index, value);
+  _end = index + 1;
+}
+
+void VCDWriter::samples(uint64_t index, const uint8_t *values, uint32_t count)
+{
+  if (_file == nullptr)
+    return;
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    if (_first || ((values[i] ^ _last) & _mask))
+      change(index + i, values[i]);
+  }
+  _end = index + count;
+}
+
+//
+// VCDWriter privates
+//
+
+void VCDWriter::change(uint64_t index, uint8_t value)
+{
+  uint64_t ns = index * 1000000000ull / _sample_rate;
+  fprintf(_file, "#%llu\n", (unsigned long long)ns);
+  if (_first)
+    fprintf(_file, "$dumpvars\n");
+
+  uint8_t changed = _first ? _mask : (value ^ _last) & _mask;
+  for (int32_t pin = 0; pin < 8; ++pin)
+  {
+    if (changed & (1 << pin))
+      fprintf(_file, "%c%c\n", value & (1 << pin) ? '1' : '0', vcd_id(pin));
+  }
+  if (_first)
+    fprintf(_file, "$end\n");
+
+  _last = value;
+  _first = false;
+}
+
+} // namespace ft232gpio